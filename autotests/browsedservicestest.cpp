@@ -0,0 +1,133 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "browsedservices_p.h"
+#include "fakebackend.h"
+
+#include <QTest>
+
+using namespace KDNSSD;
+
+class BrowsedServicesTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testFoundOrder();
+    void testNames();
+    void testBatch();
+    void testBatchComeAndGo();
+    void testBatchAddedAgain();
+
+private:
+    struct Entry {
+        int value = 0;
+        quint64 found = 0;
+    };
+
+    static QStringList foundOrder(const BrowsedServices<Entry> &services);
+};
+
+QStringList BrowsedServicesTest::foundOrder(const BrowsedServices<Entry> &services)
+{
+    QStringList names;
+    for (const auto &it : services.inOrder()) {
+        names.append(it.key().name);
+    }
+    return names;
+}
+
+static ServiceKey key(const QString &name)
+{
+    return ServiceKey(name, QStringLiteral("_http._tcp"), QStringLiteral("local."));
+}
+
+void BrowsedServicesTest::testFoundOrder()
+{
+    BrowsedServices<Entry> services;
+    for (const QString &name : {QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c"), QStringLiteral("d")}) {
+        services.insert(key(name));
+    }
+    services.erase(services.entries.find(key(QStringLiteral("b"))));
+    services.insert(key(QStringLiteral("b")));
+    services.erase(services.entries.find(key(QStringLiteral("a"))));
+    // a service found again goes to the end
+    QCOMPARE(foundOrder(services), QStringList({QStringLiteral("c"), QStringLiteral("d"), QStringLiteral("b")}));
+
+    services.clear();
+    QVERIFY(services.inOrder().isEmpty());
+    QVERIFY(services.names.isEmpty());
+}
+
+void BrowsedServicesTest::testNames()
+{
+    BrowsedServices<Entry> services;
+    services.insert(key(QStringLiteral("a"))).value = 1;
+    services.insert(key(QStringLiteral("b"))).value = 2;
+    QCOMPARE(services.names.value(QStringLiteral("b")), key(QStringLiteral("b")));
+    QCOMPARE(services.entries.value(services.names.value(QStringLiteral("b"))).value, 2);
+
+    services.erase(services.entries.find(key(QStringLiteral("b"))));
+    QVERIFY(!services.names.contains(QStringLiteral("b")));
+    QCOMPARE(services.names.size(), 1);
+}
+
+void BrowsedServicesTest::testBatch()
+{
+    const QList<RemoteService::Ptr> list = FakeBackend::services(3);
+    ServiceBatch batch;
+    QVERIFY(batch.isEmpty());
+    for (const RemoteService::Ptr &svr : list) {
+        batch.add(svr);
+    }
+    QVERIFY(!batch.isEmpty());
+    QVERIFY(batch.takeRemoved().isEmpty());
+    QCOMPARE(batch.takeAdded(), list);
+    QVERIFY(batch.isEmpty());
+
+    // removals of services sent in an earlier batch are passed on
+    batch.remove(list.at(1));
+    QCOMPARE(batch.takeRemoved(), QList<RemoteService::Ptr>({list.at(1)}));
+    QVERIFY(batch.takeAdded().isEmpty());
+}
+
+void BrowsedServicesTest::testBatchComeAndGo()
+{
+    const QList<RemoteService::Ptr> list = FakeBackend::services(4);
+    ServiceBatch batch;
+    for (const RemoteService::Ptr &svr : list) {
+        batch.add(svr);
+    }
+    batch.remove(list.at(0));
+    batch.remove(list.at(2));
+    // neither of them makes it into the batch
+    QVERIFY(batch.takeRemoved().isEmpty());
+    QCOMPARE(batch.takeAdded(), QList<RemoteService::Ptr>({list.at(1), list.at(3)}));
+    QVERIFY(batch.pending.isEmpty());
+}
+
+void BrowsedServicesTest::testBatchAddedAgain()
+{
+    const RemoteService::Ptr svr = FakeBackend::service(QStringLiteral("again"));
+    ServiceBatch batch;
+    batch.add(svr);
+    batch.remove(svr);
+    batch.add(svr);
+    QVERIFY(batch.takeRemoved().isEmpty());
+    QCOMPARE(batch.takeAdded(), QList<RemoteService::Ptr>({svr}));
+
+    // gone and back within one batch is reported as both
+    batch.remove(svr);
+    batch.add(svr);
+    QCOMPARE(batch.takeRemoved(), QList<RemoteService::Ptr>({svr}));
+    QCOMPARE(batch.takeAdded(), QList<RemoteService::Ptr>({svr}));
+}
+
+QTEST_GUILESS_MAIN(BrowsedServicesTest)
+
+#include "browsedservicestest.moc"
@@ -0,0 +1,122 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "fakebackend.h"
+#include "resolvescheduler_p.h"
+#include "servicebrowser.h"
+
+using namespace KDNSSD;
+
+static QList<RemoteService *> s_resolving;
+static QList<RemoteService *> s_stopped;
+
+namespace FakeBackend
+{
+QList<RemoteService *> resolving()
+{
+    return s_resolving;
+}
+
+QList<RemoteService *> stopped()
+{
+    return s_stopped;
+}
+
+void finishResolve(RemoteService *svr, bool successful)
+{
+    s_resolving.removeOne(svr);
+    Q_EMIT svr->resolved(successful);
+}
+
+void reset()
+{
+    s_resolving.clear();
+    s_stopped.clear();
+}
+
+RemoteService::Ptr service(const QString &name)
+{
+    return RemoteService::Ptr(new RemoteService(name, QStringLiteral("_http._tcp"), QStringLiteral("local.")));
+}
+
+QList<RemoteService::Ptr> services(int count, const QString &prefix)
+{
+    QList<RemoteService::Ptr> list;
+    list.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        list.append(service(prefix + QString::number(i)));
+    }
+    return list;
+}
+}
+
+namespace KDNSSD
+{
+RemoteService::RemoteService(const QString &name, const QString &type, const QString &domain)
+    : ServiceBase(name, type, domain)
+{
+}
+
+RemoteService::~RemoteService()
+{
+    s_resolving.removeOne(this);
+    s_stopped.removeOne(this);
+}
+
+void RemoteService::resolveAsync()
+{
+    s_resolving.append(this);
+}
+
+bool RemoteService::isResolved() const
+{
+    return false;
+}
+
+void RemoteService::virtual_hook(int, void *)
+{
+}
+
+void ResolveScheduler::stopResolve(RemoteService *svr)
+{
+    s_resolving.removeOne(svr);
+    s_stopped.append(svr);
+}
+
+class ServiceBrowserPrivate
+{
+};
+
+ServiceBrowser::ServiceBrowser(const QString &, bool, const QString &, const QString &)
+    : d(nullptr)
+{
+}
+
+ServiceBrowser::~ServiceBrowser()
+{
+}
+
+bool ServiceBrowser::isAutoResolving() const
+{
+    return true;
+}
+
+void ServiceBrowser::startBrowse()
+{
+}
+
+QList<RemoteService::Ptr> ServiceBrowser::services() const
+{
+    return QList<RemoteService::Ptr>();
+}
+
+void ServiceBrowser::virtual_hook(int, void *)
+{
+}
+
+}
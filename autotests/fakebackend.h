@@ -0,0 +1,33 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef FAKEBACKEND_H
+#define FAKEBACKEND_H
+
+#include "remoteservice.h"
+#include <QList>
+
+// A backend without a daemon behind it. Resolves started by resolveAsync()
+// stay pending until the test finishes them, browsers report what the test
+// emits on their behalf.
+namespace FakeBackend
+{
+// services with a resolve in progress, in the order they were started
+QList<KDNSSD::RemoteService *> resolving();
+// services whose resolve was stopped by ResolveScheduler
+QList<KDNSSD::RemoteService *> stopped();
+
+// ends the resolve of svr and emits its resolved() signal
+void finishResolve(KDNSSD::RemoteService *svr, bool successful = true);
+void reset();
+
+KDNSSD::RemoteService::Ptr service(const QString &name);
+QList<KDNSSD::RemoteService::Ptr> services(int count, const QString &prefix = QStringLiteral("service"));
+}
+
+#endif
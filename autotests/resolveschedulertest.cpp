@@ -0,0 +1,163 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "fakebackend.h"
+#include "resolvescheduler_p.h"
+
+#include <QTest>
+#include <QThread>
+
+using namespace KDNSSD;
+
+class ResolveSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testLimit();
+    void testEnqueueTwice();
+    void testCancelQueued();
+    void testCancelInFlight();
+    void testRaiseLimit();
+    void testPerThread();
+
+private:
+    void enqueue(int count);
+
+    QList<RemoteService::Ptr> m_services;
+};
+
+static QList<RemoteService *> pointers(const QList<RemoteService::Ptr> &services)
+{
+    QList<RemoteService *> list;
+    for (const RemoteService::Ptr &svr : services) {
+        list.append(svr.data());
+    }
+    return list;
+}
+
+void ResolveSchedulerTest::init()
+{
+    ResolveScheduler::setMaximumInFlight(2);
+    FakeBackend::reset();
+}
+
+void ResolveSchedulerTest::cleanup()
+{
+    // leave the scheduler of this thread empty for the next test
+    for (const RemoteService::Ptr &svr : std::as_const(m_services)) {
+        ResolveScheduler::self()->cancel(svr);
+    }
+    m_services.clear();
+}
+
+void ResolveSchedulerTest::enqueue(int count)
+{
+    m_services = FakeBackend::services(count);
+    for (const RemoteService::Ptr &svr : std::as_const(m_services)) {
+        ResolveScheduler::self()->enqueue(svr);
+    }
+}
+
+void ResolveSchedulerTest::testLimit()
+{
+    enqueue(5);
+    QCOMPARE(FakeBackend::resolving(), pointers(m_services.mid(0, 2)));
+
+    // the queue is served in the order services were found
+    FakeBackend::finishResolve(m_services.at(1).data());
+    QCOMPARE(FakeBackend::resolving(), pointers({m_services.at(0), m_services.at(2)}));
+    FakeBackend::finishResolve(m_services.at(0).data(), false);
+    QCOMPARE(FakeBackend::resolving(), pointers(m_services.mid(2, 2)));
+    FakeBackend::finishResolve(m_services.at(2).data());
+    FakeBackend::finishResolve(m_services.at(3).data());
+    QCOMPARE(FakeBackend::resolving(), pointers({m_services.at(4)}));
+    FakeBackend::finishResolve(m_services.at(4).data());
+    QVERIFY(FakeBackend::resolving().isEmpty());
+}
+
+void ResolveSchedulerTest::testEnqueueTwice()
+{
+    enqueue(3);
+    ResolveScheduler::self()->enqueue(m_services.at(0));
+    ResolveScheduler::self()->enqueue(m_services.at(2));
+    QCOMPARE(FakeBackend::resolving(), pointers(m_services.mid(0, 2)));
+
+    FakeBackend::finishResolve(m_services.at(0).data());
+    FakeBackend::finishResolve(m_services.at(1).data());
+    QCOMPARE(FakeBackend::resolving(), pointers({m_services.at(2)}));
+    FakeBackend::finishResolve(m_services.at(2).data());
+    QVERIFY(FakeBackend::resolving().isEmpty());
+}
+
+void ResolveSchedulerTest::testCancelQueued()
+{
+    enqueue(4);
+    ResolveScheduler::self()->cancel(m_services.at(2));
+    QVERIFY(FakeBackend::stopped().isEmpty());
+
+    FakeBackend::finishResolve(m_services.at(0).data());
+    QCOMPARE(FakeBackend::resolving(), pointers({m_services.at(1), m_services.at(3)}));
+
+    // enqueued again it has to wait for the ones queued before
+    ResolveScheduler::self()->enqueue(m_services.at(2));
+    FakeBackend::finishResolve(m_services.at(1).data());
+    QCOMPARE(FakeBackend::resolving(), pointers({m_services.at(3), m_services.at(2)}));
+}
+
+void ResolveSchedulerTest::testCancelInFlight()
+{
+    enqueue(3);
+    ResolveScheduler::self()->cancel(m_services.at(0));
+    QCOMPARE(FakeBackend::stopped(), pointers({m_services.at(0)}));
+    QCOMPARE(FakeBackend::resolving(), pointers(m_services.mid(1, 2)));
+
+    // a late reply of the cancelled resolve frees no slot
+    ResolveScheduler::self()->enqueue(FakeBackend::service(QStringLiteral("late")));
+    Q_EMIT m_services.at(0)->resolved(true);
+    QCOMPARE(FakeBackend::resolving().size(), 2);
+}
+
+void ResolveSchedulerTest::testRaiseLimit()
+{
+    enqueue(5);
+    QCOMPARE(FakeBackend::resolving().size(), 2);
+    ResolveScheduler::setMaximumInFlight(4);
+    QCOMPARE(ResolveScheduler::maximumInFlight(), 4);
+    QCOMPARE(FakeBackend::resolving(), pointers(m_services.mid(0, 4)));
+
+    // lowering it lets the resolves in flight finish
+    ResolveScheduler::setMaximumInFlight(1);
+    FakeBackend::finishResolve(m_services.at(0).data());
+    QCOMPARE(FakeBackend::resolving().size(), 3);
+
+    ResolveScheduler::setMaximumInFlight(0);
+    QCOMPARE(ResolveScheduler::maximumInFlight(), 1);
+}
+
+void ResolveSchedulerTest::testPerThread()
+{
+    ResolveScheduler *scheduler = ResolveScheduler::self();
+    QCOMPARE(ResolveScheduler::self(), scheduler);
+
+    ResolveScheduler *other = nullptr;
+    QThread *thread = QThread::create([&other] {
+        other = ResolveScheduler::self();
+    });
+    thread->start();
+    thread->wait();
+    delete thread;
+    QVERIFY(other);
+    QVERIFY(other != scheduler);
+}
+
+QTEST_GUILESS_MAIN(ResolveSchedulerTest)
+
+#include "resolveschedulertest.moc"
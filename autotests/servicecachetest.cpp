@@ -0,0 +1,108 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "servicecache_p.h"
+
+#include <QTest>
+
+using namespace KDNSSD;
+
+class ServiceCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testLookup();
+    void testRemove();
+    void testExpiry();
+    void testHitsAndMisses();
+};
+
+static const QString s_name = QStringLiteral("printer");
+static const QString s_type = QStringLiteral("_ipp._tcp");
+static const QString s_domain = QStringLiteral("local.");
+
+// what resolving the service gave
+struct Resolved : ServiceBasePrivate {
+    Resolved()
+        : ServiceBasePrivate(s_name, s_type, s_domain, QStringLiteral("printer.local."), 631)
+    {
+        m_textData = TxtRecord::fromList({"rp=ipp/print"});
+    }
+};
+
+void ServiceCacheTest::testLookup()
+{
+    ServiceCache cache;
+    ServiceBasePrivate d(s_name, s_type, s_domain, QString(), 0);
+    QVERIFY(!cache.lookup(&d));
+
+    const Resolved result;
+    cache.insert(s_name, s_type, s_domain, &result);
+    QVERIFY(cache.lookup(&d));
+    QCOMPARE(d.m_hostName, QStringLiteral("printer.local."));
+    QCOMPARE(d.m_port, quint16(631));
+    QCOMPARE(d.m_textData.value("rp").toByteArray(), QByteArray("ipp/print"));
+
+    // other services are not affected
+    ServiceBasePrivate other(QStringLiteral("scanner"), s_type, s_domain, QString(), 0);
+    QVERIFY(!cache.lookup(&other));
+}
+
+void ServiceCacheTest::testRemove()
+{
+    ServiceCache cache;
+    const Resolved result;
+    cache.insert(s_name, s_type, s_domain, &result);
+    cache.remove(s_name, s_type, s_domain);
+
+    ServiceBasePrivate d(s_name, s_type, s_domain, QString(), 0);
+    QVERIFY(!cache.lookup(&d));
+    QVERIFY(d.m_hostName.isEmpty());
+}
+
+void ServiceCacheTest::testExpiry()
+{
+    ServiceCache cache(50);
+    const Resolved result;
+    cache.insert(s_name, s_type, s_domain, &result);
+
+    ServiceBasePrivate d(s_name, s_type, s_domain, QString(), 0);
+    QVERIFY(cache.lookup(&d));
+    QTest::qSleep(100);
+    ServiceBasePrivate expired(s_name, s_type, s_domain, QString(), 0);
+    QVERIFY(!cache.lookup(&expired));
+
+    // resolving again makes it valid for another lifetime
+    cache.insert(s_name, s_type, s_domain, &result);
+    QVERIFY(cache.lookup(&expired));
+}
+
+void ServiceCacheTest::testHitsAndMisses()
+{
+    ServiceCache cache;
+    ServiceBasePrivate d(s_name, s_type, s_domain, QString(), 0);
+    QVERIFY(!cache.lookupForResolve(&d));
+    QCOMPARE(cache.hits(), quint64(0));
+    QCOMPARE(cache.misses(), quint64(1));
+
+    const Resolved result;
+    cache.insert(s_name, s_type, s_domain, &result);
+    QVERIFY(cache.lookupForResolve(&d));
+    QVERIFY(cache.lookupForResolve(&d));
+    QCOMPARE(cache.hits(), quint64(2));
+    QCOMPARE(cache.misses(), quint64(1));
+
+    // only resolves count, not the lookups of browsers
+    QVERIFY(cache.lookup(&d));
+    QCOMPARE(cache.hits(), quint64(2));
+}
+
+QTEST_GUILESS_MAIN(ServiceCacheTest)
+
+#include "servicecachetest.moc"
@@ -0,0 +1,143 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "fakebackend.h"
+#include "servicebrowser.h"
+#include "servicemodel.h"
+
+#include <QSignalSpy>
+#include <QSortFilterProxyModel>
+#include <QTest>
+
+using namespace KDNSSD;
+
+class ServiceModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testAdd();
+    void testRemoveRuns();
+    void testResolved();
+    void benchmarkArrivals_data();
+    void benchmarkArrivals();
+};
+
+static QList<RemoteService::Ptr> rows(const ServiceModel &model)
+{
+    QList<RemoteService::Ptr> list;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        list.append(model.index(row, 0).data(ServiceModel::ServicePtrRole).value<RemoteService::Ptr>());
+    }
+    return list;
+}
+
+void ServiceModelTest::testAdd()
+{
+    auto browser = new ServiceBrowser(QStringLiteral("_http._tcp"), true);
+    ServiceModel model(browser);
+    QSignalSpy inserted(&model, &ServiceModel::rowsInserted);
+
+    const QList<RemoteService::Ptr> services = FakeBackend::services(3);
+    Q_EMIT browser->servicesAdded(services);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(inserted.at(0).at(1).toInt(), 0);
+    QCOMPARE(inserted.at(0).at(2).toInt(), 2);
+    QCOMPARE(rows(model), services);
+    QCOMPARE(model.index(1, ServiceModel::ServiceName).data().toString(), QStringLiteral("service1"));
+
+    // services the model has already are not added twice
+    const RemoteService::Ptr svr = FakeBackend::service(QStringLiteral("new"));
+    Q_EMIT browser->servicesAdded({services.at(0), svr});
+    QCOMPARE(inserted.count(), 2);
+    QCOMPARE(inserted.at(1).at(1).toInt(), 3);
+    QCOMPARE(inserted.at(1).at(2).toInt(), 3);
+    QCOMPARE(model.rowCount(), 4);
+
+    Q_EMIT browser->servicesAdded(services);
+    QCOMPARE(inserted.count(), 2);
+}
+
+void ServiceModelTest::testRemoveRuns()
+{
+    auto browser = new ServiceBrowser(QStringLiteral("_http._tcp"), true);
+    ServiceModel model(browser);
+    const QList<RemoteService::Ptr> services = FakeBackend::services(8);
+    Q_EMIT browser->servicesAdded(services);
+
+    QSignalSpy removed(&model, &ServiceModel::rowsRemoved);
+    // two runs, in no particular order, and a service the model does not know
+    Q_EMIT browser->servicesRemoved({services.at(5), services.at(1), FakeBackend::service(QStringLiteral("unknown")), services.at(2), services.at(6)});
+    QCOMPARE(removed.count(), 2);
+    QCOMPARE(removed.at(0).at(1).toInt(), 5);
+    QCOMPARE(removed.at(0).at(2).toInt(), 6);
+    QCOMPARE(removed.at(1).at(1).toInt(), 1);
+    QCOMPARE(removed.at(1).at(2).toInt(), 2);
+    QCOMPARE(rows(model), QList<RemoteService::Ptr>({services.at(0), services.at(3), services.at(4), services.at(7)}));
+
+    // the rows below the removed ones moved up
+    QSignalSpy changed(&model, &ServiceModel::dataChanged);
+    Q_EMIT services.at(7)->resolved(true);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(changed.at(0).at(0).value<QModelIndex>().row(), 3);
+
+    Q_EMIT browser->servicesRemoved({services.at(0)});
+    Q_EMIT services.at(7)->resolved(true);
+    QCOMPARE(changed.count(), 2);
+    QCOMPARE(changed.at(1).at(0).value<QModelIndex>().row(), 2);
+}
+
+void ServiceModelTest::testResolved()
+{
+    auto browser = new ServiceBrowser(QStringLiteral("_http._tcp"), true);
+    ServiceModel model(browser);
+    const QList<RemoteService::Ptr> services = FakeBackend::services(3);
+    Q_EMIT browser->servicesAdded(services);
+
+    QSignalSpy changed(&model, &ServiceModel::dataChanged);
+    Q_EMIT services.at(1)->resolved(true);
+    QCOMPARE(changed.count(), 1);
+    // only the row of the service, across all columns
+    QCOMPARE(changed.at(0).at(0).value<QModelIndex>(), model.index(1, 0));
+    QCOMPARE(changed.at(0).at(1).value<QModelIndex>(), model.index(1, model.columnCount() - 1));
+
+    // removed services are no longer watched
+    Q_EMIT browser->servicesRemoved({services.at(1)});
+    Q_EMIT services.at(1)->resolved(true);
+    QCOMPARE(changed.count(), 1);
+}
+
+void ServiceModelTest::benchmarkArrivals_data()
+{
+    QTest::addColumn<int>("batchSize");
+    QTest::newRow("one by one") << 1;
+    QTest::newRow("batches of 100") << 100;
+}
+
+void ServiceModelTest::benchmarkArrivals()
+{
+    QFETCH(int, batchSize);
+
+    // 1,000 arrivals seen through a sorting proxy, as a view would
+    const QList<RemoteService::Ptr> services = FakeBackend::services(1000);
+    QBENCHMARK {
+        auto browser = new ServiceBrowser(QStringLiteral("_http._tcp"), true);
+        ServiceModel model(browser);
+        QSortFilterProxyModel proxy;
+        proxy.setSourceModel(&model);
+        proxy.sort(ServiceModel::ServiceName);
+        for (qsizetype i = 0; i < services.size(); i += batchSize) {
+            Q_EMIT browser->servicesAdded(services.mid(i, batchSize));
+        }
+        QCOMPARE(proxy.rowCount(), 1000);
+    }
+}
+
+QTEST_GUILESS_MAIN(ServiceModelTest)
+
+#include "servicemodeltest.moc"
@@ -0,0 +1,115 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "stringpool_p.h"
+
+#include <QSet>
+#include <QTest>
+
+using namespace KDNSSD;
+
+class StringPoolTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testShared();
+    void testLongStrings();
+    void benchmarkBytesPerService_data();
+    void benchmarkBytesPerService();
+    void benchmarkIntern();
+    // fills the pool, keep it last
+    void testPoolLimit();
+};
+
+// a separate copy, as demarshalling a string from the bus gives
+static QString received(const char *s)
+{
+    return QString::fromUtf8(s);
+}
+
+void StringPoolTest::testShared()
+{
+    const QString first = StringPool::self()->intern(received("_http._tcp"));
+    const QString second = StringPool::self()->intern(received("_http._tcp"));
+    QCOMPARE(second, QStringLiteral("_http._tcp"));
+    QCOMPARE(second.constData(), first.constData());
+
+    const QString other = StringPool::self()->intern(received("_ipp._tcp"));
+    QVERIFY(other.constData() != first.constData());
+}
+
+void StringPoolTest::testLongStrings()
+{
+    // up to 64 characters are pooled
+    const QByteArray limit(64, 'a');
+    QCOMPARE(StringPool::self()->intern(received(limit.constData())).constData(), StringPool::self()->intern(received(limit.constData())).constData());
+
+    // longer ones, like most service names, are passed through
+    const QByteArray tooLong(65, 'b');
+    const QString first = received(tooLong.constData());
+    const QString second = received(tooLong.constData());
+    QCOMPARE(StringPool::self()->intern(first).constData(), first.constData());
+    QCOMPARE(StringPool::self()->intern(second).constData(), second.constData());
+}
+
+void StringPoolTest::benchmarkBytesPerService_data()
+{
+    QTest::addColumn<bool>("interned");
+    QTest::newRow("copies") << false;
+    QTest::newRow("interned") << true;
+}
+
+void StringPoolTest::benchmarkBytesPerService()
+{
+    QFETCH(bool, interned);
+
+    // type, domain and the TXT keys of a census of printers
+    const int count = 20000;
+    QList<QString> strings;
+    strings.reserve(count * 5);
+    for (int i = 0; i < count; ++i) {
+        for (const char *s : {"_ipp._tcp", "local.", "txtvers", "ty", "rp"}) {
+            strings.append(interned ? StringPool::self()->intern(received(s)) : received(s));
+        }
+    }
+
+    qint64 bytes = 0;
+    QSet<const QChar *> seen;
+    for (const QString &s : std::as_const(strings)) {
+        if (!seen.contains(s.constData())) {
+            seen.insert(s.constData());
+            bytes += s.size() * sizeof(QChar);
+        }
+    }
+    QTest::setBenchmarkResult(qreal(bytes) / count, QTest::BytesAllocated);
+}
+
+void StringPoolTest::benchmarkIntern()
+{
+    const QString type = received("_http._tcp");
+    QBENCHMARK {
+        StringPool::self()->intern(type);
+    }
+}
+
+void StringPoolTest::testPoolLimit()
+{
+    const QString first = StringPool::self()->intern(QStringLiteral("limit0"));
+    for (int i = 1; i < 5000; ++i) {
+        StringPool::self()->intern(QStringLiteral("limit") + QString::number(i));
+    }
+    // the pool holds 4096 strings, after that it stops growing
+    QCOMPARE(StringPool::self()->intern(received("limit0")).constData(), first.constData());
+    const QString last = received("limit4999");
+    QCOMPARE(StringPool::self()->intern(last).constData(), last.constData());
+}
+
+QTEST_GUILESS_MAIN(StringPoolTest)
+
+#include "stringpooltest.moc"
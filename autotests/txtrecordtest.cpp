@@ -0,0 +1,163 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "txtrecord_p.h"
+
+#include <QTest>
+#include <QThread>
+
+using namespace KDNSSD;
+
+class TxtRecordTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testEmpty();
+    void testFromWire();
+    void testTruncatedWire();
+    void testValueLookup();
+    void testDuplicateKeys();
+    void testFromList();
+    void testFromMap();
+    void testConcurrentToMap();
+};
+
+void TxtRecordTest::testEmpty()
+{
+    const TxtRecord record;
+    QCOMPARE(record.size(), 0);
+    QVERIFY(record.wire().isEmpty());
+    QVERIFY(record.toMap().isEmpty());
+    QVERIFY(record.value("path").isNull());
+
+    // a single zero byte is the usual way of sending no TXT data at all
+    const TxtRecord zero = TxtRecord::fromWire(QByteArray(1, '\0'));
+    QCOMPARE(zero.size(), 0);
+    QVERIFY(zero.toMap().isEmpty());
+}
+
+void TxtRecordTest::testFromWire()
+{
+    const TxtRecord record = TxtRecord::fromWire(QByteArray("\x0apath=/foo/\x04" "flag\x06" "empty=\x04=bad", 28));
+    // the entry without a key is skipped
+    QCOMPARE(record.size(), 3);
+
+    QCOMPARE(record.keyAt(0).toByteArray(), QByteArray("path"));
+    QCOMPARE(record.valueAt(0).toByteArray(), QByteArray("/foo/"));
+    QCOMPARE(record.keyAt(1).toByteArray(), QByteArray("flag"));
+    QVERIFY(!record.valueAt(1).isNull());
+    QVERIFY(record.valueAt(1).isEmpty());
+    QCOMPARE(record.keyAt(2).toByteArray(), QByteArray("empty"));
+    QVERIFY(record.valueAt(2).isEmpty());
+
+    const QMap<QString, QByteArray> map = record.toMap();
+    QCOMPARE(map.size(), 3);
+    QCOMPARE(map.value(QStringLiteral("path")), QByteArray("/foo/"));
+    // no '=' means a null value, an empty one an empty value
+    QVERIFY(map.contains(QStringLiteral("flag")));
+    QVERIFY(map.value(QStringLiteral("flag")).isNull());
+    QVERIFY(!map.value(QStringLiteral("empty")).isNull());
+    QVERIFY(map.value(QStringLiteral("empty")).isEmpty());
+
+    const QList<QByteArray> strings{"path=/foo/", "flag", "empty="};
+    QCOMPARE(record.toList(), strings);
+}
+
+void TxtRecordTest::testTruncatedWire()
+{
+    // the second string claims more bytes than there are
+    const TxtRecord record = TxtRecord::fromWire(QByteArray("\x03" "a=b\x10" "c=d", 8));
+    QCOMPARE(record.size(), 1);
+    QCOMPARE(record.keyAt(0).toByteArray(), QByteArray("a"));
+    QCOMPARE(record.valueAt(0).toByteArray(), QByteArray("b"));
+}
+
+void TxtRecordTest::testValueLookup()
+{
+    const TxtRecord record = TxtRecord::fromList({"Path=/first", "path=/second", "txtvers=1"});
+    QCOMPARE(record.value("path").toByteArray(), QByteArray("/first"));
+    QCOMPARE(record.value("PATH").toByteArray(), QByteArray("/first"));
+    QCOMPARE(record.value("txtvers").toByteArray(), QByteArray("1"));
+    QVERIFY(record.value("missing").isNull());
+}
+
+void TxtRecordTest::testDuplicateKeys()
+{
+    const TxtRecord record = TxtRecord::fromList({"a=1", "b", "a=2", "b=3"});
+    QCOMPARE(record.size(), 4);
+    QCOMPARE(record.value("a").toByteArray(), QByteArray("1"));
+
+    // the map agrees with value() on the first one
+    const QMap<QString, QByteArray> map = record.toMap();
+    QCOMPARE(map.size(), 2);
+    QCOMPARE(map.value(QStringLiteral("a")), QByteArray("1"));
+    QVERIFY(map.contains(QStringLiteral("b")));
+    QVERIFY(map.value(QStringLiteral("b")).isNull());
+}
+
+void TxtRecordTest::testFromList()
+{
+    const QByteArray tooLong(256, 'x');
+    const TxtRecord record = TxtRecord::fromList({"a=1", QByteArray(), tooLong, "b"});
+    QCOMPARE(record.wire(), QByteArray("\x03" "a=1\x01" "b", 6));
+    QCOMPARE(record.size(), 2);
+    QCOMPARE(record.toList(), QList<QByteArray>({"a=1", "b"}));
+}
+
+void TxtRecordTest::testFromMap()
+{
+    QMap<QString, QByteArray> map;
+    map[QStringLiteral("a")] = "1";
+    map[QStringLiteral("flag")] = QByteArray();
+    map[QString()] = "ignored";
+    map[QStringLiteral("long")] = QByteArray(300, 'x');
+    const TxtRecord record = TxtRecord::fromMap(map);
+
+    // entries that do not fit are only left out of the wire data
+    QCOMPARE(record.wire(), QByteArray("\x03" "a=1\x04" "flag", 9));
+    QCOMPARE(record.toMap(), map);
+
+    const TxtRecord parsed = TxtRecord::fromWire(record.wire());
+    QCOMPARE(parsed.size(), 2);
+    QCOMPARE(parsed.value("a").toByteArray(), QByteArray("1"));
+    QVERIFY(parsed.toMap().value(QStringLiteral("flag")).isNull());
+}
+
+void TxtRecordTest::testConcurrentToMap()
+{
+    QByteArray wire;
+    for (int i = 0; i < 50; ++i) {
+        const QByteArray string = "key" + QByteArray::number(i) + '=' + QByteArray::number(i);
+        wire += char(string.size()) + string;
+    }
+    const TxtRecord record = TxtRecord::fromWire(wire);
+    // copies share the lazily built map
+    const TxtRecord copy = record;
+
+    QAtomicInt complete;
+    QList<QThread *> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.append(QThread::create([&record, &copy, &complete, i] {
+            if ((i % 2 ? record : copy).toMap().size() == 50) {
+                complete.ref();
+            }
+        }));
+        threads.last()->start();
+    }
+    for (QThread *thread : std::as_const(threads)) {
+        thread->wait();
+        delete thread;
+    }
+    QCOMPARE(complete.loadRelaxed(), 8);
+    QCOMPARE(record.toMap().value(QStringLiteral("key7")), QByteArray("7"));
+}
+
+QTEST_GUILESS_MAIN(TxtRecordTest)
+
+#include "txtrecordtest.moc"
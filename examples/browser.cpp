@@ -48,7 +48,8 @@ int main(int argc, char **argv)
     KDNSSD::ServiceModel *serviceModel = nullptr;
     QObject::connect(typeBox, &QComboBox::currentTextChanged, &app, [&](const QString &type) {
         delete serviceModel;
-        auto serviceModel = new KDNSSD::ServiceModel(new KDNSSD::ServiceBrowser(type, true));
+        // switching back to a type shows what was found before right away
+        serviceModel = new KDNSSD::ServiceModel(KDNSSD::ServiceBrowser::shared(type, true));
         serviceView->setModel(serviceModel);
         QObject::connect(serviceView->selectionModel(), &QItemSelectionModel::currentRowChanged, &app, [](const auto &idx) {
             if (idx.isValid()) {
@@ -16,6 +16,7 @@
 #include <QSet>
 #include <QStandardPaths>
 #include <avahi-common/defs.h>
+#include <utility>
 
 namespace KDNSSD
 {
@@ -23,6 +24,8 @@ DomainBrowser::DomainBrowser(DomainType type, QObject *parent)
     : QObject(parent)
     , d(new DomainBrowserPrivate(type, this))
 {
+    Q_D(DomainBrowser);
+    connect(AvahiSignalDispatcher::self(), &AvahiSignalDispatcher::daemonRestarted, d, &DomainBrowserPrivate::daemonRestarted);
 }
 
 DomainBrowser::~DomainBrowser() = default;
@@ -34,54 +37,49 @@ void DomainBrowser::startBrowse()
         return;
     }
     d->m_started = true;
+    d->createBrowser();
+}
+
+void DomainBrowserPrivate::createBrowser()
+{
+    setObjectPath(QString());
+    // how to create the browser depends on the version of the daemon
+    AvahiSignalDispatcher::self()->whenReady(this, [this, generation = m_generation] {
+        if (generation == m_generation) {
+            createBrowserNow();
+        }
+    });
+}
 
-    // Do not race!
-    // https://github.com/lathiat/avahi/issues/9
-    // Avahi's DBus API is incredibly racey with signals getting fired
-    // immediately after a request was made even though we may not yet be
-    // listening. In lieu of a proper upstream fix for this we'll unfortunately
-    // have to resort to this hack:
-    // We register to all signals regardless of path and then filter them once
-    // we know what "our" path is. This is much more fragile than a proper
-    // QDBusInterface assisted signal connection but unfortunately the only way
-    // we can reliably prevent signals getting lost in the race.
-    // This uses a fancy trick whereby using QDBusMessage as last argument will
-    // give us the correct signal argument types as well as the underlying
-    // message so that we may check the message path.
-    QDBusConnection::systemBus().connect("org.freedesktop.Avahi",
-                                         "",
-                                         "org.freedesktop.Avahi.DomainBrowser",
-                                         "ItemNew",
-                                         d,
-                                         SLOT(gotGlobalItemNew(int, int, QString, uint, QDBusMessage)));
-    QDBusConnection::systemBus().connect("org.freedesktop.Avahi",
-                                         "",
-                                         "org.freedesktop.Avahi.DomainBrowser",
-                                         "ItemRemove",
-                                         d,
-                                         SLOT(gotGlobalItemRemove(int, int, QString, uint, QDBusMessage)));
-    QDBusConnection::systemBus()
-        .connect("org.freedesktop.Avahi", "", "org.freedesktop.Avahi.DomainBrowser", "AllForNow", d, SLOT(gotGlobalAllForNow(QDBusMessage)));
-    d->m_dbusObjectPath.clear();
-
-    org::freedesktop::Avahi::Server s(QStringLiteral("org.freedesktop.Avahi"), QStringLiteral("/"), QDBusConnection::systemBus());
-    QDBusReply<QDBusObjectPath> rep =
-        s.DomainBrowserNew(-1, -1, QString(), (d->m_type == Browsing) ? AVAHI_DOMAIN_BROWSER_BROWSE : AVAHI_DOMAIN_BROWSER_REGISTER, 0);
+void DomainBrowserPrivate::createBrowserNow()
+{
+    // Make sure we are subscribed before the browser exists. Unless it is
+    // only prepared, its signals may arrive before the reply carrying its
+    // path.
+    AvahiListener::subscribe();
+
+    OrgFreedesktopAvahiServerInterface *s = avahiServer();
+    const int btype = (m_type == DomainBrowser::Browsing) ? AVAHI_DOMAIN_BROWSER_BROWSE : AVAHI_DOMAIN_BROWSER_REGISTER;
+    const bool prepare = AvahiSignalDispatcher::self()->usePrepare();
+    QDBusReply<QDBusObjectPath> rep = prepare ? s->DomainBrowserPrepare(-1, -1, QString(), btype, 0) : s->DomainBrowserNew(-1, -1, QString(), btype, 0);
     if (!rep.isValid()) {
         return;
     }
 
-    d->m_dbusObjectPath = rep.value().path();
+    setObjectPath(rep.value().path());
 
     // This is held because we need to explicitly Free it!
-    d->m_browser = new org::freedesktop::Avahi::DomainBrowser(s.service(), d->m_dbusObjectPath, s.connection());
+    m_browser = new org::freedesktop::Avahi::DomainBrowser(s->service(), m_dbusObjectPath, s->connection());
+    if (prepare) {
+        startAvahiObject(m_browser);
+    }
 
-    if (d->m_type == Browsing) {
+    if (m_type == DomainBrowser::Browsing) {
         QString domains_evar = QString::fromLocal8Bit(qgetenv("AVAHI_BROWSE_DOMAINS"));
         if (!domains_evar.isEmpty()) {
             const QStringList edomains = domains_evar.split(QLatin1Char(':'));
             for (const QString &s : edomains) {
-                d->gotNewDomain(-1, -1, s, 0);
+                gotNewDomain(-1, -1, s, 0);
             }
         }
         // FIXME: watch this file and restart browser if it changes
@@ -89,32 +87,98 @@ void DomainBrowser::startBrowse()
         QFile domains_cfg(confDir + QStringLiteral("/avahi/browse-domains"));
         if (domains_cfg.open(QIODevice::ReadOnly | QIODevice::Text))
             while (!domains_cfg.atEnd()) {
-                d->gotNewDomain(-1, -1, QString::fromUtf8(domains_cfg.readLine().data()).trimmed(), 0);
+                gotNewDomain(-1, -1, QString::fromUtf8(domains_cfg.readLine().data()).trimmed(), 0);
             }
     }
 }
 
-void DomainBrowserPrivate::gotGlobalItemNew(int interface, int protocol, const QString &domain, uint flags, QDBusMessage msg)
+void DomainBrowser::stopBrowse()
 {
-    if (!isOurMsg(msg)) {
+    Q_D(DomainBrowser);
+    if (!d->m_started) {
         return;
     }
-    gotNewDomain(interface, protocol, domain, flags);
+    d->releaseBrowser(true);
+    d->m_domains.clear();
+    d->m_stale.clear();
+    d->m_started = false;
+    d->m_paused = false;
 }
 
-void DomainBrowserPrivate::gotGlobalItemRemove(int interface, int protocol, const QString &domain, uint flags, QDBusMessage msg)
+void DomainBrowser::pause()
 {
-    if (!isOurMsg(msg)) {
+    Q_D(DomainBrowser);
+    if (!d->m_started || d->m_paused) {
         return;
     }
-    gotRemoveDomain(interface, protocol, domain, flags);
+    d->releaseBrowser(true);
+    d->m_paused = true;
 }
 
-void DomainBrowserPrivate::gotGlobalAllForNow(QDBusMessage msg)
+void DomainBrowser::resume()
 {
-    if (!isOurMsg(msg)) {
+    Q_D(DomainBrowser);
+    if (!d->m_paused) {
         return;
     }
+    d->m_paused = false;
+    d->resync();
+}
+
+bool DomainBrowser::isPaused() const
+{
+    Q_D(const DomainBrowser);
+    return d->m_paused;
+}
+
+void DomainBrowserPrivate::releaseBrowser(bool free)
+{
+    ++m_generation;
+    if (m_browser && free) {
+        freeAvahiObject(m_browser);
+    }
+    delete m_browser;
+    m_browser = nullptr;
+    setObjectPath(QString());
+}
+
+void DomainBrowserPrivate::resync()
+{
+    // keep the domains and only report those the new browser does not find
+    m_stale.unite(std::exchange(m_domains, {}));
+    createBrowser();
+}
+
+void DomainBrowserPrivate::daemonRestarted()
+{
+    if (!m_started || m_paused) {
+        return;
+    }
+    // The browser died with the daemon, and its path may belong to
+    // someone else by now, so it must not be freed.
+    releaseBrowser(false);
+    resync();
+}
+
+void DomainBrowserPrivate::browserFinished()
+{
+    const QSet<QString> gone = std::exchange(m_stale, {});
+    for (const QString &domain : gone) {
+        Q_EMIT m_parent->domainRemoved(domain);
+    }
+}
+
+void DomainBrowserPrivate::handleSignal(const QDBusMessage &msg)
+{
+    const QList<QVariant> args = msg.arguments();
+    const QString member = msg.member();
+    if (member == QLatin1String("ItemNew") && args.size() == 4) {
+        gotNewDomain(args.at(0).toInt(), args.at(1).toInt(), args.at(2).toString(), args.at(3).toUInt());
+    } else if (member == QLatin1String("ItemRemove") && args.size() == 4) {
+        gotRemoveDomain(args.at(0).toInt(), args.at(1).toInt(), args.at(2).toString(), args.at(3).toUInt());
+    } else if (member == QLatin1String("AllForNow")) {
+        browserFinished();
+    }
 }
 
 void DomainBrowserPrivate::gotNewDomain(int, int, const QString &domain, uint)
@@ -124,13 +188,19 @@ void DomainBrowserPrivate::gotNewDomain(int, int, const QString &domain, uint)
         return;
     }
     m_domains += decoded;
-    Q_EMIT m_parent->domainAdded(decoded);
+    // known from before the daemon restarted already
+    if (!m_stale.remove(decoded)) {
+        Q_EMIT m_parent->domainAdded(decoded);
+    }
 }
 
 void DomainBrowserPrivate::gotRemoveDomain(int, int, const QString &domain, uint)
 {
     QString decoded = DNSToDomain(domain);
     if (!m_domains.contains(decoded)) {
+        if (m_stale.remove(decoded)) {
+            Q_EMIT m_parent->domainRemoved(decoded);
+        }
         return;
     }
     Q_EMIT m_parent->domainRemoved(decoded);
@@ -140,7 +210,7 @@ void DomainBrowserPrivate::gotRemoveDomain(int, int, const QString &domain, uint
 QStringList DomainBrowser::domains() const
 {
     Q_D(const DomainBrowser);
-    return d->m_domains.values();
+    return (d->m_domains | d->m_stale).values();
 }
 
 bool DomainBrowser::isRunning() const
@@ -30,7 +30,7 @@ public:
     ~DomainBrowserPrivate() override
     {
         if (m_browser) {
-            m_browser->Free();
+            freeAvahiObject(m_browser);
         }
     }
 
@@ -38,15 +38,30 @@ public:
     org::freedesktop::Avahi::DomainBrowser *m_browser = nullptr;
     DomainBrowser *m_parent = nullptr;
     bool m_started = false;
+    bool m_paused = false;
     QSet<QString> m_domains;
+    // domains reported before the daemon restarted or browsing was paused
+    // that the new browser has not found again yet, removed once it is done
+    QSet<QString> m_stale;
+    // Bumped whenever the browser is released, a browser that is still to
+    // be created for an older one is not.
+    quint64 m_generation = 0;
 
-public Q_SLOTS:
-    // NB: The global slots are runtime connected! If their signature changes
-    // make sure the SLOT() signature gets updated!
-    void gotGlobalItemNew(int interface, int protocol, const QString &domain, uint flags, QDBusMessage msg);
-    void gotGlobalItemRemove(int interface, int protocol, const QString &domain, uint flags, QDBusMessage msg);
-    void gotGlobalAllForNow(QDBusMessage msg);
+    void createBrowser();
+    void createBrowserNow();
+    // detaches from the daemon-side browser, free is false if it is gone already
+    void releaseBrowser(bool free);
+    // browses anew, reporting only the differences to the domains known
+    void resync();
+    void daemonRestarted();
+    void browserFinished();
+    void handleSignal(const QDBusMessage &msg) override;
+    QString avahiInterface() const override
+    {
+        return QStringLiteral("org.freedesktop.Avahi.DomainBrowser");
+    }
 
+public Q_SLOTS:
     void gotNewDomain(int, int, const QString &, uint);
     void gotRemoveDomain(int, int, const QString &, uint);
 };
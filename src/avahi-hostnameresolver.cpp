@@ -0,0 +1,135 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "avahi_server_interface.h"
+#include "hostnameresolver.h"
+#include <QDBusPendingCallWatcher>
+#include <QTimer>
+#include <avahi-common/address.h>
+
+// time allowed for the other address family once the first address is in
+#define SETTLE_TIMEOUT 200
+
+namespace KDNSSD
+{
+class HostNameResolverPrivate : public QObject
+{
+public:
+    HostNameResolverPrivate(HostNameResolver *parent, const QString &hostName)
+        : m_parent(parent)
+        , m_hostName(hostName)
+    {
+        m_settle.setSingleShot(true);
+        connect(&m_settle, &QTimer::timeout, this, &HostNameResolverPrivate::finish);
+    }
+
+    HostNameResolver *m_parent;
+    QString m_hostName;
+    QList<QHostAddress> m_addresses;
+    // lookups in flight, ResolveHostName answers with one address per family
+    int m_pending = 0;
+    // A family the host has no address of only fails once the daemon
+    // gives up, which takes seconds. The lookup ends shortly after the
+    // first address instead.
+    QTimer m_settle;
+    bool m_running = false;
+    // Bumped whenever a lookup is started or cancelled, replies belonging
+    // to an older one are dropped.
+    quint64 m_generation = 0;
+
+    void lookup(int protocol);
+    void finish();
+};
+
+void HostNameResolverPrivate::lookup(int protocol)
+{
+    const quint64 generation = m_generation;
+    auto watcher = new QDBusPendingCallWatcher(avahiServer()->ResolveHostNameAsync(-1, -1, m_hostName, protocol, 0), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, generation](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        if (generation != m_generation) {
+            return;
+        }
+        const QDBusPendingReply<int, int, QString, int, QString, uint> rep = *watcher;
+        if (rep.isValid()) {
+            const QHostAddress address(rep.argumentAt<4>());
+            if (!address.isNull()) {
+                m_addresses.append(address);
+            }
+        }
+        if (--m_pending == 0) {
+            finish();
+        } else if (!m_addresses.isEmpty() && !m_settle.isActive()) {
+            m_settle.start(SETTLE_TIMEOUT);
+        }
+    });
+}
+
+void HostNameResolverPrivate::finish()
+{
+    m_settle.stop();
+    // the reply of a family still in flight comes too late
+    ++m_generation;
+    m_pending = 0;
+    m_running = false;
+    Q_EMIT m_parent->resolved(!m_addresses.isEmpty());
+}
+
+HostNameResolver::HostNameResolver(const QString &hostName, QObject *parent)
+    : QObject(parent)
+    , d(new HostNameResolverPrivate(this, hostName))
+{
+}
+
+HostNameResolver::~HostNameResolver() = default;
+
+QString HostNameResolver::hostName() const
+{
+    Q_D(const HostNameResolver);
+    return d->m_hostName;
+}
+
+void HostNameResolver::resolveAsync()
+{
+    Q_D(HostNameResolver);
+    if (d->m_running) {
+        return;
+    }
+    d->m_addresses.clear();
+    d->m_running = true;
+    ++d->m_generation;
+    // both families at once, neither waits for the other
+    d->m_pending = 2;
+    d->lookup(AVAHI_PROTO_INET);
+    d->lookup(AVAHI_PROTO_INET6);
+}
+
+void HostNameResolver::cancel()
+{
+    Q_D(HostNameResolver);
+    ++d->m_generation;
+    d->m_settle.stop();
+    d->m_pending = 0;
+    d->m_running = false;
+}
+
+bool HostNameResolver::isRunning() const
+{
+    Q_D(const HostNameResolver);
+    return d->m_running;
+}
+
+QList<QHostAddress> HostNameResolver::addresses() const
+{
+    Q_D(const HostNameResolver);
+    return d->m_addresses;
+}
+
+}
+
+#include "moc_hostnameresolver.cpp"
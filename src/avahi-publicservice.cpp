@@ -8,9 +8,12 @@
 
 #include "avahi-publicservice_p.h"
 
-#include <QCoreApplication>
+#include <QDBusPendingCallWatcher>
+#include <QPointer>
 #include <QStringList>
 
+#include <utility>
+
 #include "publicservice.h"
 
 #include <config-kdnssd.h>
@@ -20,6 +23,7 @@
 #include "avahi_entrygroup_interface.h"
 #include "avahi_server_interface.h"
 #include "servicebrowser.h"
+#include "syncwaiter_p.h"
 
 namespace KDNSSD
 {
@@ -32,6 +36,10 @@ PublicService::PublicService(const QString &name, const QString &type, unsigned
         d->m_domain = "local.";
     }
     d->m_subtypes = subtypes;
+    d->m_updateTimer.setSingleShot(true);
+    d->m_updateTimer.setInterval(0);
+    connect(&d->m_updateTimer, &QTimer::timeout, d, &PublicServicePrivate::applyUpdate);
+    connect(AvahiSignalDispatcher::self(), &AvahiSignalDispatcher::daemonRestarted, d, &PublicServicePrivate::daemonRestarted);
 }
 
 PublicService::~PublicService()
@@ -41,60 +49,260 @@ PublicService::~PublicService()
 
 void PublicServicePrivate::tryApply()
 {
-    if (fillEntryGroup()) {
-        commit();
-    } else {
-        m_parent->stop();
-        Q_EMIT m_parent->published(false);
+    // Group and host name do not depend on each other, ask for both at
+    // once. We get here again as soon as each of them is known.
+    if (!m_group && !m_groupPending) {
+        createGroup();
+    }
+    if (m_serviceName.isNull() && !m_hostNamePending) {
+        requestHostName();
+    }
+    if (!m_group || m_serviceName.isNull()) {
+        return;
     }
+    addService(++m_generation);
+}
+
+void PublicServicePrivate::createGroup()
+{
+    registerTypes();
+    m_groupPending = true;
+    setObjectPath(QString());
+    // the subscriptions depend on the version of the daemon
+    AvahiSignalDispatcher::self()->whenReady(this, [this] {
+        createGroupNow();
+    });
 }
 
-void PublicServicePrivate::gotGlobalStateChanged(int state, const QString &error, QDBusMessage msg)
+void PublicServicePrivate::createGroupNow()
 {
-    if (!isOurMsg(msg)) {
+    // Signals arriving before the reply carrying its path are held back
+    // until we know our path.
+    AvahiSignalDispatcher::self()->beginCreate(avahiInterface());
+
+    auto watcher = new QDBusPendingCallWatcher(avahiServer()->EntryGroupNewAsync());
+    QPointer<PublicServicePrivate> guard(this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, watcher, [guard](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        const QDBusPendingReply<QDBusObjectPath> rep = *watcher;
+        if (guard) {
+            guard->groupCreated(rep);
+        } else if (rep.isValid()) {
+            // We are gone already, don't leave the group behind in the daemon.
+            freeAvahiObject(rep.value().path(), QStringLiteral("org.freedesktop.Avahi.EntryGroup"));
+        }
+        AvahiSignalDispatcher::self()->endCreate(QStringLiteral("org.freedesktop.Avahi.EntryGroup"));
+    });
+}
+
+void PublicServicePrivate::groupCreated(const QDBusPendingReply<QDBusObjectPath> &rep)
+{
+    m_groupPending = false;
+    if (!rep.isValid()) {
+        if (m_running) {
+            fail();
+        }
         return;
     }
-    groupStateChanged(state, error);
+
+    const QString path = rep.value().path();
+    m_group = new org::freedesktop::Avahi::EntryGroup(QStringLiteral("org.freedesktop.Avahi"), path, QDBusConnection::systemBus());
+    // This also replays any signal that arrived before the reply.
+    setObjectPath(path);
+
+    // while the server is busy we are applied once it is running again
+    if (m_running && !m_collision) {
+        tryApply();
+    }
+}
+
+void PublicServicePrivate::requestHostName()
+{
+    m_hostNamePending = true;
+    auto watcher = new QDBusPendingCallWatcher(avahiServer()->GetHostNameAsync(), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        m_hostNamePending = false;
+        if (!m_running) {
+            return;
+        }
+        const QDBusPendingReply<QString> rep = *watcher;
+        if (!rep.isValid()) {
+            fail();
+            return;
+        }
+        if (m_serviceName.isNull()) {
+            m_serviceName = rep.value();
+        }
+        if (!m_collision) {
+            tryApply();
+        }
+    });
+}
+
+void PublicServicePrivate::addService(quint64 generation)
+{
+    auto watcher = new QDBusPendingCallWatcher(
+        m_group->AddServiceAsync(-1, -1, 0, m_serviceName, m_type, domainToDNS(m_domain), m_hostName, m_port, m_textData.toList()),
+        this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, generation](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        if (generation != m_generation) {
+            return;
+        }
+        const QDBusPendingReply<> ret = *watcher;
+        if (!ret.isError()) {
+            commit(generation);
+            return;
+        }
+
+        // serious error, bail out
+        if (ret.error().name() != QLatin1String("org.freedesktop.Avahi.CollisionError")) {
+            fail();
+            return;
+        }
+
+        // name collision, try another
+        auto alternative = new QDBusPendingCallWatcher(avahiServer()->GetAlternativeServiceNameAsync(m_serviceName), this);
+        connect(alternative, &QDBusPendingCallWatcher::finished, this, [this, generation](QDBusPendingCallWatcher *alternative) {
+            alternative->deleteLater();
+            if (generation != m_generation) {
+                return;
+            }
+            const QDBusPendingReply<QString> rep = *alternative;
+            if (!rep.isValid()) {
+                fail();
+                return;
+            }
+            m_serviceName = rep.value();
+            addService(generation);
+        });
+    });
+}
+
+void PublicServicePrivate::commit(quint64 generation)
+{
+    // The daemon handles our calls in order, so the subtypes and the commit
+    // can all be sent without waiting for each other.
+    for (const QString &subtype : std::as_const(m_subtypes)) {
+        m_group->AddServiceSubtypeAsync(-1, -1, 0, m_serviceName, m_type, domainToDNS(m_domain), subtype);
+    }
+    if (m_collision) {
+        return;
+    }
+
+    // The daemon replied to our AddService call, so any state signal from
+    // before our Reset call has been delivered by now.
+    m_committed = generation;
+    auto watcher = new QDBusPendingCallWatcher(m_group->CommitAsync(), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, generation](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        const QDBusPendingReply<> ret = *watcher;
+        if (generation == m_generation && ret.isError()) {
+            fail();
+        }
+        // otherwise we are published once the group reports to be established
+    });
+}
+
+void PublicServicePrivate::reapply()
+{
+    if (!m_running) {
+        return;
+    }
+    ++m_generation;
+    if (m_group) {
+        m_group->ResetAsync();
+    }
+    // while the server is busy we are applied once it is running again
+    if (!m_collision) {
+        tryApply();
+    }
+}
+
+void PublicServicePrivate::scheduleUpdate(Update update)
+{
+    if (!m_running) {
+        return;
+    }
+    m_pendingUpdate = qMax(m_pendingUpdate, update);
+    m_updateTimer.start();
+}
+
+void PublicServicePrivate::applyUpdate()
+{
+    switch (std::exchange(m_pendingUpdate, NoUpdate)) {
+    case TextUpdate:
+        // no need to withdraw and probe the service again just for its TXT record
+        if (m_published) {
+            updateTextData();
+            break;
+        }
+        [[fallthrough]];
+    case FullUpdate:
+        reapply();
+        break;
+    case NoUpdate:
+        break;
+    }
+}
+
+void PublicServicePrivate::updateTextData()
+{
+    const quint64 generation = m_generation;
+    auto watcher = new QDBusPendingCallWatcher(
+        m_group->UpdateServiceTxtAsync(-1, -1, 0, m_serviceName, m_type, domainToDNS(m_domain), m_textData.toList()),
+        this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, generation](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        const QDBusPendingReply<> ret = *watcher;
+        // fall back to registering the service again
+        if (generation == m_generation && ret.isError()) {
+            reapply();
+        }
+    });
+}
+
+void PublicServicePrivate::fail()
+{
+    m_parent->stop();
+    Q_EMIT m_parent->published(false);
+}
+
+void PublicServicePrivate::handleSignal(const QDBusMessage &msg)
+{
+    const QList<QVariant> args = msg.arguments();
+    if (msg.member() == QLatin1String("StateChanged") && args.size() == 2) {
+        groupStateChanged(args.at(0).toInt(), args.at(1).toString());
+    }
 }
 
 void PublicService::setServiceName(const QString &serviceName)
 {
     KDNSSD_D;
     d->m_serviceName = serviceName;
-    if (d->m_running) {
-        d->m_group->Reset();
-        d->tryApply();
-    }
+    d->scheduleUpdate(PublicServicePrivate::FullUpdate);
 }
 
 void PublicService::setDomain(const QString &domain)
 {
     KDNSSD_D;
     d->m_domain = domain;
-    if (d->m_running) {
-        d->m_group->Reset();
-        d->tryApply();
-    }
+    d->scheduleUpdate(PublicServicePrivate::FullUpdate);
 }
 
 void PublicService::setType(const QString &type)
 {
     KDNSSD_D;
     d->m_type = type;
-    if (d->m_running) {
-        d->m_group->Reset();
-        d->tryApply();
-    }
+    d->scheduleUpdate(PublicServicePrivate::FullUpdate);
 }
 
 void PublicService::setSubTypes(const QStringList &subtypes)
 {
     KDNSSD_D;
     d->m_subtypes = subtypes;
-    if (d->m_running) {
-        d->m_group->Reset();
-        d->tryApply();
-    }
+    d->scheduleUpdate(PublicServicePrivate::FullUpdate);
 }
 
 QStringList PublicService::subtypes() const
@@ -107,20 +315,14 @@ void PublicService::setPort(unsigned short port)
 {
     KDNSSD_D;
     d->m_port = port;
-    if (d->m_running) {
-        d->m_group->Reset();
-        d->tryApply();
-    }
+    d->scheduleUpdate(PublicServicePrivate::FullUpdate);
 }
 
 void PublicService::setTextData(const QMap<QString, QByteArray> &textData)
 {
     KDNSSD_D;
-    d->m_textData = textData;
-    if (d->m_running) {
-        d->m_group->Reset();
-        d->tryApply();
-    }
+    d->m_textData = TxtRecord::fromMap(textData);
+    d->scheduleUpdate(PublicServicePrivate::TextUpdate);
 }
 
 bool PublicService::isPublished() const
@@ -130,99 +332,39 @@ bool PublicService::isPublished() const
 }
 
 bool PublicService::publish()
+{
+    return publish(QDeadlineTimer(QDeadlineTimer::Forever)) == Succeeded;
+}
+
+PublicService::WaitResult PublicService::publish(QDeadlineTimer deadline)
 {
     KDNSSD_D;
+    SyncWaiter waiter(this, &PublicService::published);
     publishAsync();
-    while (d->m_running && !d->m_published) {
-        QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    // not any earlier, publishAsync() stops a running registration first
+    d->m_waiter = &waiter;
+    const WaitResult result = waiter.wait(deadline);
+    d->m_waiter = nullptr;
+    if (result == TimedOut) {
+        stop();
     }
-    return d->m_published;
+    return result;
 }
 
 void PublicService::stop()
 {
     KDNSSD_D;
     if (d->m_group) {
-        d->m_group->Reset();
+        d->m_group->ResetAsync();
     }
+    ++d->m_generation;
+    d->m_updateTimer.stop();
+    d->m_pendingUpdate = PublicServicePrivate::NoUpdate;
     d->m_running = false;
     d->m_published = false;
-}
-bool PublicServicePrivate::fillEntryGroup()
-{
-    registerTypes();
-    if (!m_group) {
-        // Do not race!
-        // https://github.com/lathiat/avahi/issues/9
-        // Avahi's DBus API is incredibly racey with signals getting fired
-        // immediately after a request was made even though we may not yet be
-        // listening. In lieu of a proper upstream fix for this we'll unfortunately
-        // have to resort to this hack:
-        // We register to all signals regardless of path and then filter them once
-        // we know what "our" path is. This is much more fragile than a proper
-        // QDBusInterface assisted signal connection but unfortunately the only way
-        // we can reliably prevent signals getting lost in the race.
-        // This uses a fancy trick whereby using QDBusMessage as last argument will
-        // give us the correct signal argument types as well as the underlying
-        // message so that we may check the message path.
-        QDBusConnection::systemBus().connect("org.freedesktop.Avahi",
-                                             "",
-                                             "org.freedesktop.Avahi.EntryGroup",
-                                             "StateChanged",
-                                             this,
-                                             SLOT(gotGlobalStateChanged(int, QString, QDBusMessage)));
-        m_dbusObjectPath.clear();
-
-        QDBusReply<QDBusObjectPath> rep = m_server->EntryGroupNew();
-        if (!rep.isValid()) {
-            return false;
-        }
-
-        m_dbusObjectPath = rep.value().path();
-
-        m_group = new org::freedesktop::Avahi::EntryGroup("org.freedesktop.Avahi", m_dbusObjectPath, QDBusConnection::systemBus());
-    }
-    if (m_serviceName.isNull()) {
-        QDBusReply<QString> rep = m_server->GetHostName();
-        if (!rep.isValid()) {
-            return false;
-        }
-        m_serviceName = rep.value();
-    }
-
-    QList<QByteArray> txt;
-    QMap<QString, QByteArray>::ConstIterator itEnd = m_textData.constEnd();
-    for (QMap<QString, QByteArray>::ConstIterator it = m_textData.constBegin(); it != itEnd; ++it)
-        if (it.value().isNull()) {
-            txt.append(it.key().toLatin1());
-        } else {
-            txt.append(it.key().toLatin1() + '=' + it.value());
-        }
-
-    for (;;) {
-        QDBusReply<void> ret = m_group->AddService(-1, -1, 0, m_serviceName, m_type, domainToDNS(m_domain), m_hostName, m_port, txt);
-        if (ret.isValid()) {
-            break;
-        }
-
-        // serious error, bail out
-        if (ret.error().name() != QLatin1String("org.freedesktop.Avahi.CollisionError")) {
-            return false;
-        }
-
-        // name collision, try another
-        QDBusReply<QString> rep = m_server->GetAlternativeServiceName(m_serviceName);
-        if (rep.isValid()) {
-            m_serviceName = rep.value();
-        } else {
-            return false;
-        }
+    if (d->m_waiter) {
+        d->m_waiter->finish(false);
     }
-
-    for (const QString &subtype : std::as_const(m_subtypes)) {
-        m_group->AddServiceSubtype(-1, -1, 0, m_serviceName, m_type, domainToDNS(m_domain), subtype);
-    }
-    return true;
 }
 
 void PublicServicePrivate::serverStateChanged(int s, const QString &)
@@ -232,14 +374,14 @@ void PublicServicePrivate::serverStateChanged(int s, const QString &)
     }
     switch (s) {
     case AVAHI_SERVER_INVALID:
-        m_parent->stop();
-        Q_EMIT m_parent->published(false);
+        fail();
         break;
     case AVAHI_SERVER_REGISTERING:
     case AVAHI_SERVER_COLLISION:
         if (m_group) {
-            m_group->Reset();
+            m_group->ResetAsync();
         }
+        ++m_generation;
         m_collision = true;
         break;
     case AVAHI_SERVER_RUNNING:
@@ -257,32 +399,65 @@ void PublicService::publishAsync()
         stop();
     }
 
-    if (!d->m_server) {
-        d->m_server = new org::freedesktop::Avahi::Server(QStringLiteral("org.freedesktop.Avahi"), QStringLiteral("/"), QDBusConnection::systemBus());
-        connect(d->m_server, SIGNAL(StateChanged(int, QString)), d, SLOT(serverStateChanged(int, QString)));
+    if (!d->m_serverConnected) {
+        connect(avahiServer(), &OrgFreedesktopAvahiServerInterface::StateChanged, d, &PublicServicePrivate::serverStateChanged);
+        d->m_serverConnected = true;
     }
 
-    int state = AVAHI_SERVER_INVALID;
-    QDBusReply<int> rep = d->m_server->GetState();
+    d->start();
+}
+
+void PublicServicePrivate::start()
+{
+    m_running = true;
+    m_collision = true; // make it look like server is getting out of collision to force registering
+    auto watcher = new QDBusPendingCallWatcher(avahiServer()->GetStateAsync(), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        const QDBusPendingReply<int> rep = *watcher;
+        serverStateChanged(rep.isValid() ? rep.value() : int(AVAHI_SERVER_INVALID), QString());
+    });
+}
 
-    if (rep.isValid()) {
-        state = rep.value();
+void PublicServicePrivate::daemonRestarted()
+{
+    if (!m_running) {
+        return;
+    }
+    // The entry group died with the daemon, and its path may belong to
+    // someone else by now, so it must not be freed.
+    delete m_group;
+    m_group = nullptr;
+    setObjectPath(QString());
+    ++m_generation;
+    // published(true) follows once registered with the new daemon
+    if (std::exchange(m_published, false)) {
+        Q_EMIT m_parent->published(false);
     }
-    d->m_running = true;
-    d->m_collision = true; // make it look like server is getting out of collision to force registering
-    d->serverStateChanged(state, QString());
+    start();
 }
 
 void PublicServicePrivate::groupStateChanged(int s, const QString &reason)
 {
+    if (!m_running || m_committed != m_generation) {
+        return;
+    }
     switch (s) {
     case AVAHI_ENTRY_GROUP_COLLISION: {
-        QDBusReply<QString> rep = m_server->GetAlternativeServiceName(m_serviceName);
-        if (rep.isValid()) {
-            m_parent->setServiceName(rep.value());
-        } else {
-            serverStateChanged(AVAHI_SERVER_INVALID, reason);
-        }
+        const quint64 generation = m_generation;
+        auto watcher = new QDBusPendingCallWatcher(avahiServer()->GetAlternativeServiceNameAsync(m_serviceName), this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, generation, reason](QDBusPendingCallWatcher *watcher) {
+            watcher->deleteLater();
+            if (generation != m_generation) {
+                return;
+            }
+            const QDBusPendingReply<QString> rep = *watcher;
+            if (rep.isValid()) {
+                m_parent->setServiceName(rep.value());
+            } else {
+                serverStateChanged(AVAHI_SERVER_INVALID, reason);
+            }
+        });
         break;
     }
     case AVAHI_ENTRY_GROUP_ESTABLISHED:
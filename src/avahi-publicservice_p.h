@@ -14,13 +14,17 @@
 #include "avahi_server_interface.h"
 #include "publicservice.h"
 #include "servicebase_p.h"
+#include <QDBusPendingReply>
 #include <QStringList>
+#include <QTimer>
 #include <avahi-common/defs.h>
 
 #define KDNSSD_D PublicServicePrivate *d = static_cast<PublicServicePrivate *>(this->d.operator->())
 
 namespace KDNSSD
 {
+class SyncWaiter;
+
 class PublicServicePrivate : public QObject, public ServiceBasePrivate, public AvahiListener
 {
     Q_OBJECT
@@ -31,7 +35,6 @@ public:
         , m_published(false)
         , m_running(false)
         , m_group(nullptr)
-        , m_server(nullptr)
         , m_collision(false)
         , m_parent(parent)
     {
@@ -39,35 +42,66 @@ public:
     ~PublicServicePrivate() override
     {
         if (m_group) {
-            m_group->Free();
+            freeAvahiObject(m_group);
         }
         delete m_group;
-        delete m_server;
     }
 
     bool m_published;
     bool m_running;
     org::freedesktop::Avahi::EntryGroup *m_group;
-    org::freedesktop::Avahi::Server *m_server;
+    bool m_serverConnected = false;
     bool m_collision;
     QStringList m_subtypes;
     PublicService *m_parent;
+    bool m_groupPending = false;
+    bool m_hostNamePending = false;
+    // Bumped whenever a registration is started over or abandoned, replies
+    // belonging to an older one are dropped.
+    quint64 m_generation = 0;
+    // Generation whose Commit has been sent. The group's states before that
+    // belong to a registration that has been reset.
+    quint64 m_committed = 0;
+
+    // Changes made by the setters are applied once control returns to the
+    // event loop, so that a batch of them costs a single registration.
+    enum Update {
+        NoUpdate,
+        TextUpdate,
+        FullUpdate,
+    };
+    Update m_pendingUpdate = NoUpdate;
+    QTimer m_updateTimer;
+    // set while publish() blocks, stop() ends the wait
+    SyncWaiter *m_waiter = nullptr;
+    void scheduleUpdate(Update update);
+    void applyUpdate();
+
+    // Registration is a chain of asynchronous calls, each step continues
+    // with the next one from its reply.
+    void start();
+    void tryApply();
+    void createGroup();
+    void createGroupNow();
+    void groupCreated(const QDBusPendingReply<QDBusObjectPath> &rep);
+    void requestHostName();
+    void addService(quint64 generation);
+    void commit(quint64 generation);
+    // Withdraws the service and registers it again with the current data.
+    void reapply();
+    // Replaces the TXT record of the published service in place.
+    void updateTextData();
+    void fail();
+    // registers the service anew with the restarted daemon
+    void daemonRestarted();
 
-    void commit()
+    void handleSignal(const QDBusMessage &msg) override;
+    QString avahiInterface() const override
     {
-        if (!m_collision) {
-            m_group->Commit();
-        }
+        return QStringLiteral("org.freedesktop.Avahi.EntryGroup");
     }
-    void stop();
-    bool fillEntryGroup();
-    void tryApply();
 
 public Q_SLOTS:
-    // NB: The global slots are runtime connected! If their signature changes
-    // make sure the SLOT() signature gets updated!
-    void gotGlobalStateChanged(int state, const QString &error, QDBusMessage msg);
-
     void serverStateChanged(int, const QString &);
     void groupStateChanged(int, const QString &);
 };
@@ -0,0 +1,446 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "avahi-publicservicegroup_p.h"
+#include "avahi-publicservice_p.h"
+#include "avahi_server_interface.h"
+#include <QDBusPendingCallWatcher>
+#include <avahi-common/defs.h>
+
+namespace KDNSSD
+{
+PublicServiceGroup::PublicServiceGroup(QObject *parent)
+    : QObject(parent)
+    , d(new PublicServiceGroupPrivate(this))
+{
+    Q_D(PublicServiceGroup);
+    connect(AvahiSignalDispatcher::self(), &AvahiSignalDispatcher::daemonRestarted, d, &PublicServiceGroupPrivate::daemonRestarted);
+}
+
+PublicServiceGroup::~PublicServiceGroup()
+{
+    stop();
+}
+
+void PublicServiceGroup::addService(PublicService *service)
+{
+    Q_D(PublicServiceGroup);
+    if (!service || d->m_services.contains(service)) {
+        return;
+    }
+    d->m_services.append(service);
+    connect(service, &QObject::destroyed, d, [d]() {
+        d->m_services.removeAll(nullptr);
+        d->reapply();
+    });
+    d->reapply();
+}
+
+void PublicServiceGroup::removeService(PublicService *service)
+{
+    Q_D(PublicServiceGroup);
+    if (!d->m_services.removeAll(service)) {
+        return;
+    }
+    disconnect(service, &QObject::destroyed, d, nullptr);
+    PublicServiceGroupPrivate::member(service)->m_published = false;
+    d->reapply();
+}
+
+QList<PublicService *> PublicServiceGroup::services() const
+{
+    Q_D(const PublicServiceGroup);
+    QList<PublicService *> services;
+    services.reserve(d->m_services.size());
+    for (const QPointer<PublicService> &service : d->m_services) {
+        if (service) {
+            services.append(service);
+        }
+    }
+    return services;
+}
+
+void PublicServiceGroup::publishAsync()
+{
+    Q_D(PublicServiceGroup);
+    if (d->m_running) {
+        stop();
+    }
+
+    if (!d->m_serverConnected) {
+        connect(avahiServer(), &OrgFreedesktopAvahiServerInterface::StateChanged, d, &PublicServiceGroupPrivate::serverStateChanged);
+        d->m_serverConnected = true;
+    }
+
+    d->start();
+}
+
+void PublicServiceGroup::stop()
+{
+    Q_D(PublicServiceGroup);
+    if (d->m_group) {
+        d->m_group->ResetAsync();
+    }
+    ++d->m_generation;
+    d->m_running = false;
+    d->setPublished(false);
+}
+
+bool PublicServiceGroup::isPublished() const
+{
+    Q_D(const PublicServiceGroup);
+    return d->m_published;
+}
+
+void PublicServiceGroupPrivate::start()
+{
+    m_running = true;
+    m_collision = true; // make it look like server is getting out of collision to force registering
+    auto watcher = new QDBusPendingCallWatcher(avahiServer()->GetStateAsync(), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        const QDBusPendingReply<int> rep = *watcher;
+        serverStateChanged(rep.isValid() ? rep.value() : int(AVAHI_SERVER_INVALID), QString());
+    });
+}
+
+void PublicServiceGroupPrivate::daemonRestarted()
+{
+    if (!m_running) {
+        return;
+    }
+    // The entry group died with the daemon, and its path may belong to
+    // someone else by now, so it must not be freed.
+    delete m_group;
+    m_group = nullptr;
+    setObjectPath(QString());
+    ++m_generation;
+    // published(true) follows once registered with the new daemon
+    const bool wasPublished = m_published;
+    setPublished(false);
+    if (wasPublished) {
+        Q_EMIT m_parent->published(false);
+    }
+    start();
+}
+
+PublicServicePrivate *PublicServiceGroupPrivate::member(PublicService *service)
+{
+    return static_cast<PublicServicePrivate *>(service->d.get());
+}
+
+void PublicServiceGroupPrivate::tryApply()
+{
+    m_services.removeAll(nullptr);
+    bool needHostName = false;
+    for (const QPointer<PublicService> &service : std::as_const(m_services)) {
+        needHostName |= member(service)->m_serviceName.isNull();
+    }
+
+    // Group and host name do not depend on each other, ask for both at
+    // once. We get here again as soon as each of them is known.
+    if (!m_group && !m_groupPending) {
+        createGroup();
+    }
+    if (needHostName && !m_hostNamePending) {
+        requestHostName();
+    }
+    if (!m_group || needHostName) {
+        return;
+    }
+    addServices(++m_generation);
+}
+
+void PublicServiceGroupPrivate::createGroup()
+{
+    registerTypes();
+    m_groupPending = true;
+    setObjectPath(QString());
+    // the subscriptions depend on the version of the daemon
+    AvahiSignalDispatcher::self()->whenReady(this, [this] {
+        createGroupNow();
+    });
+}
+
+void PublicServiceGroupPrivate::createGroupNow()
+{
+    // Signals arriving before the reply carrying its path are held back
+    // until we know our path.
+    AvahiSignalDispatcher::self()->beginCreate(avahiInterface());
+
+    auto watcher = new QDBusPendingCallWatcher(avahiServer()->EntryGroupNewAsync());
+    QPointer<PublicServiceGroupPrivate> guard(this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, watcher, [guard](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        const QDBusPendingReply<QDBusObjectPath> rep = *watcher;
+        if (guard) {
+            guard->groupCreated(rep);
+        } else if (rep.isValid()) {
+            // We are gone already, don't leave the group behind in the daemon.
+            freeAvahiObject(rep.value().path(), QStringLiteral("org.freedesktop.Avahi.EntryGroup"));
+        }
+        AvahiSignalDispatcher::self()->endCreate(QStringLiteral("org.freedesktop.Avahi.EntryGroup"));
+    });
+}
+
+void PublicServiceGroupPrivate::groupCreated(const QDBusPendingReply<QDBusObjectPath> &rep)
+{
+    m_groupPending = false;
+    if (!rep.isValid()) {
+        if (m_running) {
+            fail();
+        }
+        return;
+    }
+
+    const QString path = rep.value().path();
+    m_group = new org::freedesktop::Avahi::EntryGroup(QStringLiteral("org.freedesktop.Avahi"), path, QDBusConnection::systemBus());
+    // This also replays any signal that arrived before the reply.
+    setObjectPath(path);
+
+    // while the server is busy we are applied once it is running again
+    if (m_running && !m_collision) {
+        tryApply();
+    }
+}
+
+void PublicServiceGroupPrivate::requestHostName()
+{
+    m_hostNamePending = true;
+    auto watcher = new QDBusPendingCallWatcher(avahiServer()->GetHostNameAsync(), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        m_hostNamePending = false;
+        if (!m_running) {
+            return;
+        }
+        const QDBusPendingReply<QString> rep = *watcher;
+        if (!rep.isValid()) {
+            fail();
+            return;
+        }
+        // members sharing the host name are told apart by collision handling
+        for (const QPointer<PublicService> &service : std::as_const(m_services)) {
+            if (service && member(service)->m_serviceName.isNull()) {
+                member(service)->m_serviceName = rep.value();
+            }
+        }
+        if (!m_collision) {
+            tryApply();
+        }
+    });
+}
+
+void PublicServiceGroupPrivate::addServices(quint64 generation)
+{
+    if (m_services.isEmpty()) {
+        // nothing to announce, an empty entry group cannot be committed
+        setPublished(true);
+        return;
+    }
+    // all members are added at once, each one retries on its own collisions
+    m_pendingAdds = m_services.size();
+    for (const QPointer<PublicService> &service : std::as_const(m_services)) {
+        addService(service, generation);
+    }
+}
+
+void PublicServiceGroupPrivate::addService(PublicService *service, quint64 generation)
+{
+    PublicServicePrivate *s = member(service);
+    auto watcher = new QDBusPendingCallWatcher(
+        m_group->AddServiceAsync(-1, -1, 0, s->m_serviceName, s->m_type, domainToDNS(s->m_domain), s->m_hostName, s->m_port, s->m_textData.toList()),
+        this);
+    QPointer<PublicService> guard(service);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, generation, guard](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        // a deleted member starts the registration over
+        if (generation != m_generation || !guard) {
+            return;
+        }
+        PublicServicePrivate *s = member(guard);
+        const QDBusPendingReply<> ret = *watcher;
+        if (!ret.isError()) {
+            // The daemon handles our calls in order, the subtypes do not
+            // have to be waited for before committing.
+            for (const QString &subtype : std::as_const(s->m_subtypes)) {
+                m_group->AddServiceSubtypeAsync(-1, -1, 0, s->m_serviceName, s->m_type, domainToDNS(s->m_domain), subtype);
+            }
+            if (--m_pendingAdds == 0) {
+                commit(generation);
+            }
+            return;
+        }
+
+        // serious error, bail out
+        if (ret.error().name() != QLatin1String("org.freedesktop.Avahi.CollisionError")) {
+            fail();
+            return;
+        }
+
+        // name collision, try another for this member only
+        auto alternative = new QDBusPendingCallWatcher(avahiServer()->GetAlternativeServiceNameAsync(s->m_serviceName), this);
+        connect(alternative, &QDBusPendingCallWatcher::finished, this, [this, generation, guard](QDBusPendingCallWatcher *alternative) {
+            alternative->deleteLater();
+            if (generation != m_generation || !guard) {
+                return;
+            }
+            const QDBusPendingReply<QString> rep = *alternative;
+            if (!rep.isValid()) {
+                fail();
+                return;
+            }
+            member(guard)->m_serviceName = rep.value();
+            addService(guard, generation);
+        });
+    });
+}
+
+void PublicServiceGroupPrivate::commit(quint64 generation)
+{
+    if (m_collision) {
+        return;
+    }
+    // The daemon replied to all our AddService calls, so any state signal
+    // from before our Reset call has been delivered by now.
+    m_committed = generation;
+    auto watcher = new QDBusPendingCallWatcher(m_group->CommitAsync(), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, generation](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        const QDBusPendingReply<> ret = *watcher;
+        if (generation == m_generation && ret.isError()) {
+            fail();
+        }
+        // otherwise we are published once the group reports to be established
+    });
+}
+
+void PublicServiceGroupPrivate::renameAll()
+{
+    // Avahi does not tell which record of the group collided, so every
+    // member moves on to its next alternative name.
+    const quint64 generation = ++m_generation;
+    m_services.removeAll(nullptr);
+    if (m_services.isEmpty()) {
+        reapply();
+        return;
+    }
+    m_pendingAdds = m_services.size();
+    for (const QPointer<PublicService> &service : std::as_const(m_services)) {
+        auto watcher = new QDBusPendingCallWatcher(avahiServer()->GetAlternativeServiceNameAsync(member(service)->m_serviceName), this);
+        QPointer<PublicService> guard(service);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, generation, guard](QDBusPendingCallWatcher *watcher) {
+            watcher->deleteLater();
+            if (generation != m_generation) {
+                return;
+            }
+            const QDBusPendingReply<QString> rep = *watcher;
+            if (!rep.isValid()) {
+                serverStateChanged(AVAHI_SERVER_INVALID, QString());
+                return;
+            }
+            if (guard) {
+                member(guard)->m_serviceName = rep.value();
+            }
+            if (--m_pendingAdds == 0) {
+                reapply();
+            }
+        });
+    }
+}
+
+void PublicServiceGroupPrivate::reapply()
+{
+    if (!m_running) {
+        return;
+    }
+    ++m_generation;
+    setPublished(false);
+    if (m_group) {
+        m_group->ResetAsync();
+    }
+    // while the server is busy we are applied once it is running again
+    if (!m_collision) {
+        tryApply();
+    }
+}
+
+void PublicServiceGroupPrivate::setPublished(bool published)
+{
+    m_published = published;
+    for (const QPointer<PublicService> &service : std::as_const(m_services)) {
+        if (service) {
+            member(service)->m_published = published;
+        }
+    }
+    if (published) {
+        Q_EMIT m_parent->published(true);
+    }
+}
+
+void PublicServiceGroupPrivate::fail()
+{
+    m_parent->stop();
+    Q_EMIT m_parent->published(false);
+}
+
+void PublicServiceGroupPrivate::handleSignal(const QDBusMessage &msg)
+{
+    const QList<QVariant> args = msg.arguments();
+    if (msg.member() == QLatin1String("StateChanged") && args.size() == 2) {
+        groupStateChanged(args.at(0).toInt(), args.at(1).toString());
+    }
+}
+
+void PublicServiceGroupPrivate::serverStateChanged(int s, const QString &)
+{
+    if (!m_running) {
+        return;
+    }
+    switch (s) {
+    case AVAHI_SERVER_INVALID:
+        fail();
+        break;
+    case AVAHI_SERVER_REGISTERING:
+    case AVAHI_SERVER_COLLISION:
+        if (m_group) {
+            m_group->ResetAsync();
+        }
+        ++m_generation;
+        m_collision = true;
+        break;
+    case AVAHI_SERVER_RUNNING:
+        if (m_collision) {
+            m_collision = false;
+            tryApply();
+        }
+    }
+}
+
+void PublicServiceGroupPrivate::groupStateChanged(int s, const QString &reason)
+{
+    if (!m_running || m_committed != m_generation) {
+        return;
+    }
+    switch (s) {
+    case AVAHI_ENTRY_GROUP_COLLISION:
+        renameAll();
+        break;
+    case AVAHI_ENTRY_GROUP_ESTABLISHED:
+        setPublished(true);
+        break;
+    case AVAHI_ENTRY_GROUP_FAILURE:
+        serverStateChanged(AVAHI_SERVER_INVALID, reason);
+        break;
+    }
+}
+
+}
+
+#include "moc_avahi-publicservicegroup_p.cpp"
+#include "moc_publicservicegroup.cpp"
@@ -0,0 +1,91 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef AVAHI_PUBLICSERVICEGROUP_P_H
+#define AVAHI_PUBLICSERVICEGROUP_P_H
+
+#include "avahi_entrygroup_interface.h"
+#include "avahi_listener_p.h"
+#include "publicservice.h"
+#include "publicservicegroup.h"
+#include <QDBusPendingReply>
+#include <QList>
+#include <QPointer>
+
+namespace KDNSSD
+{
+class PublicServicePrivate;
+
+class PublicServiceGroupPrivate : public QObject, public AvahiListener
+{
+    Q_OBJECT
+public:
+    PublicServiceGroupPrivate(PublicServiceGroup *parent)
+        : m_parent(parent)
+    {
+    }
+    ~PublicServiceGroupPrivate() override
+    {
+        if (m_group) {
+            freeAvahiObject(m_group);
+        }
+        delete m_group;
+    }
+
+    QList<QPointer<PublicService>> m_services;
+    PublicServiceGroup *m_parent;
+    org::freedesktop::Avahi::EntryGroup *m_group = nullptr;
+    bool m_groupPending = false;
+    bool m_hostNamePending = false;
+    bool m_running = false;
+    bool m_published = false;
+    bool m_collision = false;
+    bool m_serverConnected = false;
+    // Bumped whenever a registration is started over or abandoned, replies
+    // belonging to an older one are dropped.
+    quint64 m_generation = 0;
+    // Generation whose Commit has been sent. The group's states before that
+    // belong to a registration that has been reset.
+    quint64 m_committed = 0;
+    // members whose AddService call has not succeeded yet
+    int m_pendingAdds = 0;
+
+    static PublicServicePrivate *member(PublicService *service);
+
+    // Same chain of asynchronous calls as for a single PublicService, only
+    // that all members go into one entry group that is committed once.
+    void start();
+    void tryApply();
+    void createGroup();
+    void createGroupNow();
+    void groupCreated(const QDBusPendingReply<QDBusObjectPath> &rep);
+    void requestHostName();
+    void addServices(quint64 generation);
+    void addService(PublicService *service, quint64 generation);
+    void commit(quint64 generation);
+    void renameAll();
+    void reapply();
+    void setPublished(bool published);
+    void fail();
+    // registers the group anew with the restarted daemon
+    void daemonRestarted();
+
+    void handleSignal(const QDBusMessage &msg) override;
+    QString avahiInterface() const override
+    {
+        return QStringLiteral("org.freedesktop.Avahi.EntryGroup");
+    }
+
+public Q_SLOTS:
+    void serverStateChanged(int, const QString &);
+    void groupStateChanged(int, const QString &);
+};
+
+}
+
+#endif
@@ -11,15 +11,23 @@
 #include "avahi_server_interface.h"
 #include "avahi_serviceresolver_interface.h"
 #include "remoteservice.h"
-#include <QCoreApplication>
+#include "resolvescheduler_p.h"
+#include "servicecache_p.h"
+#include "stringpool_p.h"
+#include "syncwaiter_p.h"
+#include <QDBusArgument>
+#include <QDBusPendingCallWatcher>
 #include <QDebug>
-#include <QEventLoop>
 #include <netinet/in.h>
+
+#include <limits>
 namespace KDNSSD
 {
 RemoteService::RemoteService(const QString &name, const QString &type, const QString &domain)
     : ServiceBase(new RemoteServicePrivate(this, name, type, domain))
 {
+    KDNSSD_D;
+    d->m_resolved = ServiceCache::self()->lookup(d);
 }
 
 RemoteService::~RemoteService()
@@ -27,13 +35,23 @@ RemoteService::~RemoteService()
 }
 
 bool RemoteService::resolve()
+{
+    return resolve(QDeadlineTimer(QDeadlineTimer::Forever)) == Succeeded;
+}
+
+RemoteService::WaitResult RemoteService::resolve(QDeadlineTimer deadline)
 {
     KDNSSD_D;
+    if (d->m_resolveMode == ResolveOnce && !d->m_running) {
+        return d->resolveBlocking(deadline);
+    }
+    SyncWaiter waiter(this, &RemoteService::resolved);
     resolveAsync();
-    while (d->m_running && !d->m_resolved) {
-        QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    const WaitResult result = waiter.wait(deadline);
+    if (result == TimedOut) {
+        d->stop();
     }
-    return d->m_resolved;
+    return result;
 }
 
 void RemoteService::resolveAsync()
@@ -45,44 +63,66 @@ void RemoteService::resolveAsync()
     d->m_resolved = false;
     registerTypes();
 
-    // Do not race!
-    // https://github.com/lathiat/avahi/issues/9
-    // Avahi's DBus API is incredibly racey with signals getting fired
-    // immediately after a request was made even though we may not yet be
-    // listening. In lieu of a proper upstream fix for this we'll unfortunately
-    // have to resort to this hack:
-    // We register to all signals regardless of path and then filter them once
-    // we know what "our" path is. This is much more fragile than a proper
-    // QDBusInterface assisted signal connection but unfortunately the only way
-    // we can reliably prevent signals getting lost in the race.
-    // This uses a fancy trick whereby using QDBusMessage as last argument will
-    // give us the correct signal argument types as well as the underlying
-    // message so that we may check the message path.
-    QDBusConnection::systemBus().connect(
-        "org.freedesktop.Avahi",
-        "",
-        "org.freedesktop.Avahi.ServiceResolver",
-        "Found",
-        d,
-        SLOT(gotGlobalFound(int, int, QString, QString, QString, QString, int, QString, ushort, QList<QByteArray>, uint, QDBusMessage)));
-    QDBusConnection::systemBus()
-        .connect("org.freedesktop.Avahi", "", "org.freedesktop.Avahi.ServiceResolver", "Failure", d, SLOT(gotGlobalError(QDBusMessage)));
-    d->m_dbusObjectPath.clear();
-
-    // qDebug() << this << ":Starting resolve of : " << d->m_serviceName << " " << d->m_type << " " << d->m_domain << "\n";
-    org::freedesktop::Avahi::Server s(QStringLiteral("org.freedesktop.Avahi"), QStringLiteral("/"), QDBusConnection::systemBus());
+    if (d->m_resolveMode == ResolveOnce && ServiceCache::self()->lookupForResolve(d)) {
+        d->m_resolved = true;
+        Q_EMIT resolved(true);
+        return;
+    }
+
+    if (d->m_resolveMode == ResolveOnce) {
+        // A single ResolveService call, no daemon-side object to create,
+        // listen to and free afterwards.
+        d->m_running = true;
+        // FIXME: don't use LOOKUP_NO_ADDRESS if NSS unavailable
+        d->m_pendingResolve = new QDBusPendingCallWatcher(
+            avahiServer()->ResolveServiceAsync(-1, -1, d->m_serviceName, d->m_type, domainToDNS(d->m_domain), -1, 8 /*AVAHI_LOOKUP_NO_ADDRESS*/),
+            d);
+        connect(d->m_pendingResolve, &QDBusPendingCallWatcher::finished, d, &RemoteServicePrivate::gotResolveReply);
+        return;
+    }
+
+    d->setObjectPath(QString());
+    d->m_running = true;
+    connect(AvahiSignalDispatcher::self(),
+            &AvahiSignalDispatcher::daemonRestarted,
+            d,
+            &RemoteServicePrivate::daemonRestarted,
+            Qt::UniqueConnection);
+    // how to create the resolver depends on the version of the daemon
+    AvahiSignalDispatcher::self()->whenReady(d, [d, generation = d->m_generation] {
+        if (generation == d->m_generation) {
+            d->createResolver();
+        }
+    });
+}
+
+void RemoteServicePrivate::createResolver()
+{
+    // Make sure we are subscribed before the resolver exists. Unless it is
+    // only prepared, its signals may arrive before the reply carrying its
+    // path.
+    AvahiListener::subscribe();
+
+    // qDebug() << this << ":Starting resolve of : " << m_serviceName << " " << m_type << " " << m_domain << "\n";
+    OrgFreedesktopAvahiServerInterface *s = avahiServer();
+    const bool prepare = AvahiSignalDispatcher::self()->usePrepare();
     // FIXME: don't use LOOKUP_NO_ADDRESS if NSS unavailable
-    QDBusReply<QDBusObjectPath> rep = s.ServiceResolverNew(-1, -1, d->m_serviceName, d->m_type, domainToDNS(d->m_domain), -1, 8 /*AVAHI_LOOKUP_NO_ADDRESS*/);
+    QDBusReply<QDBusObjectPath> rep = prepare
+        ? s->ServiceResolverPrepare(-1, -1, m_serviceName, m_type, domainToDNS(m_domain), -1, 8 /*AVAHI_LOOKUP_NO_ADDRESS*/)
+        : s->ServiceResolverNew(-1, -1, m_serviceName, m_type, domainToDNS(m_domain), -1, 8 /*AVAHI_LOOKUP_NO_ADDRESS*/);
     if (!rep.isValid()) {
-        Q_EMIT resolved(false);
+        m_running = false;
+        Q_EMIT m_parent->resolved(false);
         return;
     }
 
-    d->m_dbusObjectPath = rep.value().path();
+    setObjectPath(rep.value().path());
 
     // This is held because we need to explicitly Free it!
-    d->m_resolver = new org::freedesktop::Avahi::ServiceResolver(s.service(), d->m_dbusObjectPath, s.connection());
-    d->m_running = true;
+    m_resolver = new org::freedesktop::Avahi::ServiceResolver(s->service(), m_dbusObjectPath, s->connection());
+    if (prepare) {
+        startAvahiObject(m_resolver);
+    }
 }
 
 bool RemoteService::isResolved() const
@@ -91,39 +131,103 @@ bool RemoteService::isResolved() const
     return d->m_resolved;
 }
 
+void RemoteService::setResolveMode(ResolveMode mode)
+{
+    KDNSSD_D;
+    d->m_resolveMode = mode;
+}
+
+RemoteService::ResolveMode RemoteService::resolveMode() const
+{
+    KDNSSD_D;
+    return d->m_resolveMode;
+}
+
+RemoteService::WaitResult RemoteServicePrivate::resolveBlocking(QDeadlineTimer deadline)
+{
+    m_resolved = false;
+    registerTypes();
+    if (ServiceCache::self()->lookupForResolve(this)) {
+        m_resolved = true;
+        Q_EMIT m_parent->resolved(true);
+        return RemoteService::Succeeded;
+    }
+    if (deadline.hasExpired()) {
+        return RemoteService::TimedOut;
+    }
+
+    // The timeout of the call is our deadline, so waiting for its reply
+    // is all there is to do. No event is processed meanwhile.
+    const qint64 remaining = deadline.isForever() ? std::numeric_limits<int>::max() : deadline.remainingTime();
+    const int timeout = int(qMin<qint64>(remaining, std::numeric_limits<int>::max()));
+    OrgFreedesktopAvahiServerInterface *s = avahiServer();
+    QDBusMessage call = QDBusMessage::createMethodCall(s->service(), s->path(), s->interface(), QStringLiteral("ResolveService"));
+    // FIXME: don't use LOOKUP_NO_ADDRESS if NSS unavailable
+    call << -1 << -1 << m_serviceName << m_type << domainToDNS(m_domain) << -1 << uint(8 /*AVAHI_LOOKUP_NO_ADDRESS*/);
+    QDBusPendingCall pending = QDBusConnection::systemBus().asyncCall(call, timeout);
+    pending.waitForFinished();
+
+    if (pending.isError() && pending.error().type() == QDBusError::NoReply && deadline.hasExpired()) {
+        return RemoteService::TimedOut;
+    }
+    return gotResolveMessage(pending.reply()) ? RemoteService::Succeeded : RemoteService::Failed;
+}
+
+void RemoteServicePrivate::gotResolveReply(QDBusPendingCallWatcher *watcher)
+{
+    watcher->deleteLater();
+    m_pendingResolve = nullptr;
+    m_running = false;
+    gotResolveMessage(watcher->reply());
+}
+
+bool RemoteServicePrivate::gotResolveMessage(const QDBusMessage &reply)
+{
+    if (reply.type() != QDBusMessage::ReplyMessage || !gotFoundArguments(reply.arguments())) {
+        m_resolved = false;
+        Q_EMIT m_parent->resolved(false);
+        return false;
+    }
+    return true;
+}
+
 void RemoteServicePrivate::gotError()
 {
+    ServiceCache::self()->remove(m_serviceName, m_type, m_domain);
     m_resolved = false;
     stop();
 
     Q_EMIT m_parent->resolved(false);
 }
 
-void RemoteServicePrivate::gotGlobalFound(int interface,
-                                          int protocol,
-                                          const QString &name,
-                                          const QString &type,
-                                          const QString &domain,
-                                          const QString &host,
-                                          int aprotocol,
-                                          const QString &address,
-                                          ushort port,
-                                          const QList<QByteArray> &txt,
-                                          uint flags,
-                                          QDBusMessage msg)
-{
-    if (!isOurMsg(msg)) {
-        return;
+void RemoteServicePrivate::handleSignal(const QDBusMessage &msg)
+{
+    const QList<QVariant> args = msg.arguments();
+    const QString member = msg.member();
+    if (member == QLatin1String("Found")) {
+        gotFoundArguments(args);
+    } else if (member == QLatin1String("Failure")) {
+        gotError();
     }
-    gotFound(interface, protocol, name, type, domain, host, aprotocol, address, port, txt, flags);
 }
 
-void RemoteServicePrivate::gotGlobalError(QDBusMessage msg)
+bool RemoteServicePrivate::gotFoundArguments(const QList<QVariant> &args)
 {
-    if (!isOurMsg(msg)) {
-        return;
+    if (args.size() != 11) {
+        return false;
     }
-    gotError();
+    gotFound(args.at(0).toInt(),
+             args.at(1).toInt(),
+             args.at(2).toString(),
+             args.at(3).toString(),
+             args.at(4).toString(),
+             args.at(5).toString(),
+             args.at(6).toInt(),
+             args.at(7).toString(),
+             args.at(8).value<ushort>(),
+             qdbus_cast<QList<QByteArray>>(args.at(9)),
+             args.at(10).toUInt());
+    return true;
 }
 
 void RemoteServicePrivate::gotFound(int,
@@ -138,32 +242,52 @@ void RemoteServicePrivate::gotFound(int,
                                     const QList<QByteArray> &txt,
                                     uint)
 {
+    const QString cacheName = m_serviceName;
+    const QString cacheDomain = m_domain;
     m_serviceName = name;
     m_hostName = host;
     m_port = port;
-    m_domain = DNSToDomain(domain);
-    for (const QByteArray &x : txt) {
-        int pos = x.indexOf("=");
-        if (pos == -1) {
-            m_textData[x] = QByteArray();
-        } else {
-            m_textData[x.mid(0, pos)] = x.mid(pos + 1, x.size() - pos);
-        }
-    }
+    m_domain = StringPool::self()->intern(DNSToDomain(domain));
+    m_textData = TxtRecord::fromList(txt);
     m_resolved = true;
+    ServiceCache::self()->insert(cacheName, m_type, cacheDomain, this);
     Q_EMIT m_parent->resolved(true);
 }
 
+void RemoteServicePrivate::daemonRestarted()
+{
+    if (!m_resolver) {
+        return;
+    }
+    ++m_generation;
+    // The resolver died with the daemon, and its path may belong to
+    // someone else by now, so it must not be freed.
+    delete m_resolver;
+    m_resolver = nullptr;
+    setObjectPath(QString());
+    m_running = false;
+    m_parent->resolveAsync();
+}
+
 void RemoteServicePrivate::stop()
 {
+    ++m_generation;
+    delete m_pendingResolve;
+    m_pendingResolve = nullptr;
     if (m_resolver) {
-        m_resolver->Free();
+        freeAvahiObject(m_resolver);
     }
     delete m_resolver;
     m_resolver = nullptr;
+    setObjectPath(QString());
     m_running = false;
 }
 
+void ResolveScheduler::stopResolve(RemoteService *svr)
+{
+    static_cast<RemoteServicePrivate *>(svr->d.operator->())->stop();
+}
+
 void RemoteService::virtual_hook(int, void *)
 {
     // BASE::virtual_hook(int, void*);
@@ -13,6 +13,7 @@
 #include "avahi_serviceresolver_interface.h"
 #include "remoteservice.h"
 #include "servicebase_p.h"
+#include <QDBusPendingCallWatcher>
 #include <QList>
 #include <QMap>
 #include <QString>
@@ -37,33 +38,39 @@ public:
     ~RemoteServicePrivate() override
     {
         if (m_resolver) {
-            m_resolver->Free();
+            freeAvahiObject(m_resolver);
         }
         delete m_resolver;
     }
     bool m_resolved = false;
     bool m_running = false;
+    RemoteService::ResolveMode m_resolveMode = RemoteService::ResolveOnce;
     org::freedesktop::Avahi::ServiceResolver *m_resolver = nullptr;
+    QDBusPendingCallWatcher *m_pendingResolve = nullptr;
     RemoteService *m_parent = nullptr;
+    // Bumped whenever resolving is stopped, a resolver that is still to be
+    // created for an older resolve is not.
+    quint64 m_generation = 0;
     void stop();
+    // creates the resolver of a monitored service
+    void createResolver();
+    // re-creates the resolver of a monitored service
+    void daemonRestarted();
 
-private Q_SLOTS:
-    // NB: The global slots are runtime connected! If their signature changes
-    // make sure the SLOT() signature gets updated!
-    void gotGlobalFound(int interface,
-                        int protocol,
-                        const QString &name,
-                        const QString &type,
-                        const QString &domain,
-                        const QString &host,
-                        int aprotocol,
-                        const QString &address,
-                        ushort port,
-                        const QList<QByteArray> &txt,
-                        uint flags,
-                        QDBusMessage msg);
-    void gotGlobalError(QDBusMessage msg);
+    void handleSignal(const QDBusMessage &msg) override;
+    QString avahiInterface() const override
+    {
+        return QStringLiteral("org.freedesktop.Avahi.ServiceResolver");
+    }
+    // feeds the arguments of a Found signal or ResolveService reply to gotFound()
+    bool gotFoundArguments(const QList<QVariant> &args);
+    // reports the outcome of a ResolveService call
+    bool gotResolveMessage(const QDBusMessage &reply);
+    // Resolves once without an event loop, blocking on the reply of a
+    // single ResolveService call.
+    RemoteService::WaitResult resolveBlocking(QDeadlineTimer deadline);
 
+private Q_SLOTS:
     void gotFound(int interface,
                   int protocol,
                   const QString &name,
@@ -76,6 +83,7 @@ private Q_SLOTS:
                   const QList<QByteArray> &txt,
                   uint flags);
     void gotError();
+    void gotResolveReply(QDBusPendingCallWatcher *watcher);
 };
 
 }
@@ -10,10 +10,17 @@
 #include "avahi-servicebrowser_p.h"
 #include "avahi_server_interface.h"
 #include "avahi_servicebrowser_interface.h"
+#include "resolvescheduler_p.h"
 #include "servicebrowser.h"
+#include "servicecache_p.h"
+#include "stringpool_p.h"
+#include <QDBusPendingCallWatcher>
 #include <QHash>
 #include <QHostAddress>
+#include <QPointer>
 #include <QStringList>
+#include <avahi-common/defs.h>
+#include <utility>
 
 namespace KDNSSD
 {
@@ -26,13 +33,18 @@ ServiceBrowser::ServiceBrowser(const QString &type, bool autoResolve, const QStr
     d->m_autoResolve = autoResolve;
     d->m_domain = domain;
     d->m_timer.setSingleShot(true);
+    // bursts of signals are handled within one event loop pass, report
+    // them together once it is over
+    d->m_batchTimer.setSingleShot(true);
+    d->m_batchTimer.setInterval(0);
+    connect(&d->m_batchTimer, &QTimer::timeout, d, &ServiceBrowserPrivate::flushBatch);
+    connect(&d->m_timer, &QTimer::timeout, d, &ServiceBrowserPrivate::browserFinished);
+    connect(AvahiSignalDispatcher::self(), &AvahiSignalDispatcher::daemonRestarted, d, &ServiceBrowserPrivate::daemonRestarted);
 }
 
 ServiceBrowser::State ServiceBrowser::isAvailable()
 {
-    org::freedesktop::Avahi::Server s(QStringLiteral("org.freedesktop.Avahi"), QStringLiteral("/"), QDBusConnection::systemBus());
-    QDBusReply<int> rep = s.GetState();
-    return (rep.isValid() && rep.value() == 2) ? Working : Stopped;
+    return avahiServerState() == AVAHI_SERVER_RUNNING ? Working : Stopped;
 }
 
 ServiceBrowser::~ServiceBrowser() = default;
@@ -49,173 +61,382 @@ void ServiceBrowser::startBrowse()
     if (d->m_running) {
         return;
     }
+    d->m_running = true;
+    d->setObjectPath(QString());
+    // how to create the browser depends on the version of the daemon
+    AvahiSignalDispatcher::self()->whenReady(d, [d, generation = d->m_generation] {
+        if (generation == d->m_generation) {
+            d->createBrowser(generation);
+        }
+    });
+}
 
-    // Do not race!
-    // https://github.com/lathiat/avahi/issues/9
-    // Avahi's DBus API is incredibly racey with signals getting fired
-    // immediately after a request was made even though we may not yet be
-    // listening. In lieu of a proper upstream fix for this we'll unfortunately
-    // have to resort to this hack:
-    // We register to all signals regardless of path and then filter them once
-    // we know what "our" path is. This is much more fragile than a proper
-    // QDBusInterface assisted signal connection but unfortunately the only way
-    // we can reliably prevent signals getting lost in the race.
-    // This uses a fancy trick whereby using QDBusMessage as last argument will
-    // give us the correct signal argument types as well as the underlying
-    // message so that we may check the message path.
-    QDBusConnection::systemBus().connect("org.freedesktop.Avahi",
-                                         "",
-                                         "org.freedesktop.Avahi.ServiceBrowser",
-                                         "ItemNew",
-                                         d,
-                                         SLOT(gotGlobalItemNew(int, int, QString, QString, QString, uint, QDBusMessage)));
-    QDBusConnection::systemBus().connect("org.freedesktop.Avahi",
-                                         "",
-                                         "org.freedesktop.Avahi.ServiceBrowser",
-                                         "ItemRemove",
-                                         d,
-                                         SLOT(gotGlobalItemRemove(int, int, QString, QString, QString, uint, QDBusMessage)));
-    QDBusConnection::systemBus()
-        .connect("org.freedesktop.Avahi", "", "org.freedesktop.Avahi.ServiceBrowser", "AllForNow", d, SLOT(gotGlobalAllForNow(QDBusMessage)));
-    d->m_dbusObjectPath.clear();
-
-    org::freedesktop::Avahi::Server s(QStringLiteral("org.freedesktop.Avahi"), QStringLiteral("/"), QDBusConnection::systemBus());
-
-    QString fullType = d->m_type;
-    if (!d->m_subtype.isEmpty()) {
-        fullType = d->m_subtype + QStringLiteral("._sub.") + d->m_type;
-    }
-    QDBusReply<QDBusObjectPath> rep = s.ServiceBrowserNew(-1, -1, fullType, domainToDNS(d->m_domain), 0);
-    if (!rep.isValid()) {
-        Q_EMIT finished();
+void ServiceBrowser::stopBrowse()
+{
+    Q_D(ServiceBrowser);
+    if (!d->m_running) {
         return;
     }
+    d->releaseBrowser(true);
+    d->m_services.clear();
+    d->m_batchTimer.stop();
+    d->m_batch.clear();
+    d->m_running = false;
+    d->m_recovering = false;
+    d->m_paused = false;
+}
 
-    d->m_dbusObjectPath = rep.value().path();
-    d->m_running = true;
-    d->m_browserFinished = true;
+void ServiceBrowser::pause()
+{
+    Q_D(ServiceBrowser);
+    if (!d->m_running || d->m_paused) {
+        return;
+    }
+    d->releaseBrowser(true);
+    d->m_paused = true;
+}
 
-    // This is held because we need to explicitly Free it!
-    d->m_browser = new org::freedesktop::Avahi::ServiceBrowser(s.service(), d->m_dbusObjectPath, s.connection());
+void ServiceBrowser::resume()
+{
+    Q_D(ServiceBrowser);
+    if (!d->m_paused) {
+        return;
+    }
+    d->m_paused = false;
+    d->resync();
+}
 
-    connect(&d->m_timer, &QTimer::timeout, d, &ServiceBrowserPrivate::browserFinished);
-    d->m_timer.start(domainIsLocal(d->m_domain) ? TIMEOUT_LAST_SERVICE : TIMEOUT_START_WAN);
+bool ServiceBrowser::isPaused() const
+{
+    Q_D(const ServiceBrowser);
+    return d->m_paused;
 }
 
-void ServiceBrowserPrivate::serviceResolved(bool success)
+void ServiceBrowserPrivate::createBrowser(quint64 generation)
 {
-    QObject *sender_obj = const_cast<QObject *>(sender());
-    RemoteService *svr = static_cast<RemoteService *>(sender_obj);
-    disconnect(svr, SIGNAL(resolved(bool)), this, SLOT(serviceResolved(bool)));
-    QList<RemoteService::Ptr>::Iterator it = m_duringResolve.begin();
-    QList<RemoteService::Ptr>::Iterator itEnd = m_duringResolve.end();
-    while (it != itEnd && svr != (*it).data()) {
-        ++it;
+    // Unless the browser is only prepared, its signals may arrive before
+    // the reply carrying its path. The dispatcher holds them back until we
+    // know our path.
+    AvahiSignalDispatcher *dispatcher = AvahiSignalDispatcher::self();
+    const bool prepare = dispatcher->usePrepare();
+    if (!prepare) {
+        dispatcher->beginCreate(avahiInterface());
     }
-    if (it != itEnd) {
-        if (success) {
-            m_services += (*it);
-            Q_EMIT m_parent->serviceAdded(RemoteService::Ptr(svr));
-        }
-        m_duringResolve.erase(it);
-        queryFinished();
+
+    QString fullType = m_type;
+    if (!m_subtype.isEmpty()) {
+        fullType = m_subtype + QStringLiteral("._sub.") + m_type;
     }
+    auto watcher = new QDBusPendingCallWatcher(prepare ? avahiServer()->ServiceBrowserPrepareAsync(-1, -1, fullType, domainToDNS(m_domain), 0)
+                                                       : avahiServer()->ServiceBrowserNewAsync(-1, -1, fullType, domainToDNS(m_domain), 0));
+    QPointer<ServiceBrowserPrivate> guard(this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, watcher, [guard, prepare, generation](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        const QDBusPendingReply<QDBusObjectPath> rep = *watcher;
+        if (guard && guard->m_generation == generation) {
+            guard->browserCreated(rep, prepare);
+        } else if (rep.isValid()) {
+            // We are gone or stopped already, don't leave the browser behind in the daemon.
+            freeAvahiObject(rep.value().path(), QStringLiteral("org.freedesktop.Avahi.ServiceBrowser"));
+        }
+        if (!prepare) {
+            AvahiSignalDispatcher::self()->endCreate(QStringLiteral("org.freedesktop.Avahi.ServiceBrowser"));
+        }
+    });
 }
 
-void ServiceBrowserPrivate::gotGlobalItemNew(int interface,
-                                             int protocol,
-                                             const QString &name,
-                                             const QString &type,
-                                             const QString &domain,
-                                             uint flags,
-                                             QDBusMessage msg)
+void ServiceBrowserPrivate::browserCreated(const QDBusPendingReply<QDBusObjectPath> &rep, bool prepared)
 {
-    if (!isOurMsg(msg)) {
+    if (!rep.isValid()) {
+        m_running = false;
+        Q_EMIT m_parent->finished();
         return;
     }
-    gotNewService(interface, protocol, name, type, domain, flags);
-}
 
-void ServiceBrowserPrivate::gotGlobalItemRemove(int interface,
-                                                int protocol,
-                                                const QString &name,
-                                                const QString &type,
-                                                const QString &domain,
-                                                uint flags,
-                                                QDBusMessage msg)
-{
-    if (!isOurMsg(msg)) {
-        return;
+    const QString path = rep.value().path();
+    m_browserFinished = true;
+
+    // This is held because we need to explicitly Free it!
+    m_browser = new org::freedesktop::Avahi::ServiceBrowser(QStringLiteral("org.freedesktop.Avahi"), path, QDBusConnection::systemBus());
+
+    m_timer.start(domainIsLocal(m_domain) ? TIMEOUT_LAST_SERVICE : TIMEOUT_START_WAN);
+
+    // This also replays any signal that arrived before the reply.
+    setObjectPath(path);
+    if (prepared) {
+        startAvahiObject(m_browser);
     }
-    gotRemoveService(interface, protocol, name, type, domain, flags);
 }
 
-void ServiceBrowserPrivate::gotGlobalAllForNow(QDBusMessage msg)
+void ServiceBrowserPrivate::serviceResolved(const ServiceKey &key, bool success)
 {
-    if (!isOurMsg(msg)) {
+    auto it = m_services.entries.find(key);
+    if (it == m_services.entries.end() || !it->resolving) {
         return;
     }
-    browserFinished();
+    const RemoteService::Ptr svr = it->service;
+    disconnect(svr.data(), &RemoteService::resolved, this, nullptr);
+    --m_resolving;
+    if (success) {
+        it->resolving = false;
+        reportAdded(svr);
+    } else {
+        m_services.erase(it);
+    }
+    queryFinished();
 }
 
-RemoteService::Ptr ServiceBrowserPrivate::find(RemoteService::Ptr s, const QList<RemoteService::Ptr> &where) const
+void ServiceBrowserPrivate::handleSignal(const QDBusMessage &msg)
 {
-    for (const RemoteService::Ptr &i : where)
-        if (*s == *i) {
-            return i;
-        }
-    return RemoteService::Ptr();
+    const QList<QVariant> args = msg.arguments();
+    const QString member = msg.member();
+    if (member == QLatin1String("ItemNew") && args.size() == 6) {
+        // type and domain are the same for most services, share them
+        gotNewService(args.at(0).toInt(),
+                      args.at(1).toInt(),
+                      args.at(2).toString(),
+                      StringPool::self()->intern(args.at(3).toString()),
+                      StringPool::self()->intern(args.at(4).toString()),
+                      args.at(5).toUInt());
+    } else if (member == QLatin1String("ItemRemove") && args.size() == 6) {
+        gotRemoveService(args.at(0).toInt(), args.at(1).toInt(), args.at(2).toString(), args.at(3).toString(), args.at(4).toString(), args.at(5).toUInt());
+    } else if (member == QLatin1String("AllForNow")) {
+        browserFinished();
+    }
 }
 
-void ServiceBrowserPrivate::gotNewService(int, int, const QString &name, const QString &type, const QString &domain, uint)
+void ServiceBrowserPrivate::gotNewService(int interface, int protocol, const QString &name, const QString &type, const QString &domain, uint)
 {
     m_timer.start(TIMEOUT_LAST_SERVICE);
+    const ServiceKey key(name, type, domain);
+    auto it = m_services.entries.find(key);
+    if (it != m_services.entries.end()) {
+        // only report the first time a service is added and likewise below,
+        // the last time it is removed
+        it->instances.append(AvahiInstance{interface, protocol});
+        return;
+    }
+
+    if (m_recordMode && !m_autoResolve) {
+        m_services.insert(key).instances.append(AvahiInstance{interface, protocol});
+        Q_EMIT m_parent->recordAdded(ServiceRecord(name, type, domain));
+        return;
+    }
+
     RemoteService::Ptr svr(new RemoteService(name, type, domain));
-    if (m_autoResolve) {
-        connect(svr.data(), SIGNAL(resolved(bool)), this, SLOT(serviceResolved(bool)));
-        m_duringResolve += svr;
-        svr->resolveAsync();
+    Entry &entry = m_services.insert(key);
+    entry.service = svr;
+    entry.instances.append(AvahiInstance{interface, protocol});
+    // no need to resolve what was resolved before already
+    if (m_autoResolve && !svr->isResolved()) {
+        entry.resolving = true;
+        ++m_resolving;
+        connect(svr.data(), &RemoteService::resolved, this, [this, key](bool success) {
+            serviceResolved(key, success);
+        });
+        ResolveScheduler::self()->enqueue(svr);
     } else {
-        m_services += svr;
-        Q_EMIT m_parent->serviceAdded(svr);
+        reportAdded(svr);
     }
 }
 
-void ServiceBrowserPrivate::gotRemoveService(int, int, const QString &name, const QString &type, const QString &domain, uint)
+void ServiceBrowserPrivate::gotRemoveService(int interface, int protocol, const QString &name, const QString &type, const QString &domain, uint)
 {
     m_timer.start(TIMEOUT_LAST_SERVICE);
-    RemoteService::Ptr tmpl(new RemoteService(name, type, domain));
-    RemoteService::Ptr found = find(tmpl, m_duringResolve);
-    if (found) {
-        m_duringResolve.removeAll(found);
+    const ServiceKey key(name, type, domain);
+    auto it = m_services.entries.find(key);
+    if (it == m_services.entries.end() || !it->instances.removeOne(AvahiInstance{interface, protocol}) || !it->instances.isEmpty()) {
         return;
     }
-    found = find(tmpl, m_services);
-    if (!found) {
+
+    removeEntry(it);
+}
+
+void ServiceBrowserPrivate::removeEntry(QHash<ServiceKey, Entry>::iterator it)
+{
+    const ServiceKey key = it.key();
+    ServiceCache::self()->remove(key.name, key.type, key.domain);
+    if (m_recordMode && !m_autoResolve) {
+        Q_EMIT m_parent->recordRemoved(ServiceRecord(key.name, key.type, key.domain));
+        m_services.erase(it);
         return;
     }
 
-    Q_EMIT m_parent->serviceRemoved(found);
-    m_services.removeAll(found);
+    const RemoteService::Ptr found = it->service;
+    if (it->resolving) {
+        disconnect(found.data(), &RemoteService::resolved, this, nullptr);
+        ResolveScheduler::self()->cancel(found);
+        --m_resolving;
+        m_services.erase(it);
+        return;
+    }
+
+    // a slot connected to the removal may look at services() already
+    m_services.erase(it);
+    reportRemoved(found);
 }
+
+void ServiceBrowserPrivate::releaseBrowser(bool free)
+{
+    ++m_generation;
+    m_timer.stop();
+    if (m_browser && free) {
+        freeAvahiObject(m_browser);
+    }
+    delete m_browser;
+    m_browser = nullptr;
+    setObjectPath(QString());
+
+    for (auto it = m_services.entries.begin(); it != m_services.entries.end();) {
+        if (it->resolving) {
+            disconnect(it->service.data(), &RemoteService::resolved, this, nullptr);
+            ResolveScheduler::self()->cancel(it->service);
+            it = m_services.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_resolving = 0;
+}
+
+void ServiceBrowserPrivate::resync()
+{
+    // Keep the services and let the new browser find them again, they are
+    // only reported if they turn out to be gone.
+    for (Entry &entry : m_services.entries) {
+        entry.instances.clear();
+    }
+    m_recovering = true;
+    m_running = false;
+    m_parent->startBrowse();
+}
+
+void ServiceBrowserPrivate::daemonRestarted()
+{
+    if (!m_running || m_paused) {
+        return;
+    }
+    // The browser died with the daemon, and its path may belong to
+    // someone else by now, so it must not be freed.
+    releaseBrowser(false);
+    resync();
+}
+
 void ServiceBrowserPrivate::browserFinished()
 {
     m_timer.stop();
     m_browserFinished = true;
+    if (std::exchange(m_recovering, false)) {
+        QList<ServiceKey> gone;
+        for (auto it = m_services.entries.cbegin(); it != m_services.entries.cend(); ++it) {
+            if (it->instances.isEmpty()) {
+                gone.append(it.key());
+            }
+        }
+        for (const ServiceKey &key : std::as_const(gone)) {
+            auto it = m_services.entries.find(key);
+            if (it != m_services.entries.end()) {
+                removeEntry(it);
+            }
+        }
+    }
     queryFinished();
 }
 
 void ServiceBrowserPrivate::queryFinished()
 {
-    if (!m_duringResolve.count() && m_browserFinished) {
+    if (!m_resolving && m_browserFinished) {
+        flushBatch();
         Q_EMIT m_parent->finished();
     }
 }
 
+void ServiceBrowserPrivate::reportAdded(const RemoteService::Ptr &svr)
+{
+    Q_EMIT m_parent->serviceAdded(svr);
+    m_batch.add(svr);
+    m_batchTimer.start();
+}
+
+void ServiceBrowserPrivate::reportRemoved(const RemoteService::Ptr &svr)
+{
+    Q_EMIT m_parent->serviceRemoved(svr);
+    m_batch.remove(svr);
+    m_batchTimer.start();
+}
+
+void ServiceBrowserPrivate::flushBatch()
+{
+    m_batchTimer.stop();
+    const QList<RemoteService::Ptr> removed = m_batch.takeRemoved();
+    if (!removed.isEmpty()) {
+        Q_EMIT m_parent->servicesRemoved(removed);
+    }
+    const QList<RemoteService::Ptr> added = m_batch.takeAdded();
+    if (!added.isEmpty()) {
+        Q_EMIT m_parent->servicesAdded(added);
+    }
+}
+
+RemoteService::Ptr ServiceBrowserPrivate::serviceFor(const Entry &entry, const ServiceKey &key)
+{
+    if (!entry.service) {
+        entry.service = RemoteService::Ptr(new RemoteService(key.name, key.type, key.domain));
+    }
+    return entry.service;
+}
+
 QList<RemoteService::Ptr> ServiceBrowser::services() const
+{
+    // services of record mode entries are created on demand
+    Q_D(const ServiceBrowser);
+    QList<RemoteService::Ptr> services;
+    services.reserve(d->m_services.entries.size() - d->m_resolving);
+    for (const auto &it : d->m_services.inOrder()) {
+        if (!it->resolving) {
+            services.append(d->serviceFor(*it, it.key()));
+        }
+    }
+    return services;
+}
+
+RemoteService::Ptr ServiceBrowser::service(const QString &name) const
 {
     Q_D(const ServiceBrowser);
-    return d->m_services;
+    const auto key = d->m_services.names.constFind(name);
+    if (key == d->m_services.names.constEnd()) {
+        return RemoteService::Ptr();
+    }
+    const auto it = d->m_services.entries.constFind(*key);
+    if (it == d->m_services.entries.cend() || it->resolving) {
+        return RemoteService::Ptr();
+    }
+    return d->serviceFor(*it, it.key());
+}
+
+QList<ServiceRecord> ServiceBrowser::records() const
+{
+    Q_D(const ServiceBrowser);
+    QList<ServiceRecord> records;
+    records.reserve(d->m_services.entries.size() - d->m_resolving);
+    for (const auto &it : d->m_services.inOrder()) {
+        if (!it->resolving) {
+            records.append(ServiceRecord(it.key().name, it.key().type, it.key().domain));
+        }
+    }
+    return records;
+}
+
+void ServiceBrowser::setRecordMode(bool enable)
+{
+    Q_D(ServiceBrowser);
+    d->m_recordMode = enable;
+}
+
+bool ServiceBrowser::isRecordMode() const
+{
+    Q_D(const ServiceBrowser);
+    return d->m_recordMode;
 }
 
 void ServiceBrowser::virtual_hook(int, void *)
@@ -224,15 +445,13 @@ void ServiceBrowser::virtual_hook(int, void *)
 
 QHostAddress ServiceBrowser::resolveHostName(const QString &hostname)
 {
-    org::freedesktop::Avahi::Server s(QStringLiteral("org.freedesktop.Avahi"), QStringLiteral("/"), QDBusConnection::systemBus());
-
     int protocol = 0;
     QString name;
     int aprotocol = 0;
     QString address;
     uint flags = 0;
 
-    QDBusReply<int> reply = s.ResolveHostName(-1, -1, hostname, 0, (unsigned int)0, protocol, name, aprotocol, address, flags);
+    QDBusReply<int> reply = avahiServer()->ResolveHostName(-1, -1, hostname, 0, (unsigned int)0, protocol, name, aprotocol, address, flags);
 
     if (reply.isValid()) {
         return QHostAddress(address);
@@ -243,15 +462,7 @@ QHostAddress ServiceBrowser::resolveHostName(const QString &hostname)
 
 QString ServiceBrowser::getLocalHostName()
 {
-    org::freedesktop::Avahi::Server s(QStringLiteral("org.freedesktop.Avahi"), QStringLiteral("/"), QDBusConnection::systemBus());
-
-    QDBusReply<QString> reply = s.GetHostName();
-
-    if (reply.isValid()) {
-        return reply.value();
-    } else {
-        return QString();
-    }
+    return avahiHostName();
 }
 
 }
@@ -11,10 +11,16 @@
 
 #include "avahi_listener_p.h"
 #include "avahi_servicebrowser_interface.h"
+#include "browsedservices_p.h"
+#include "resolvescheduler_p.h"
+#include "servicebase_p.h"
 #include "servicebrowser.h"
+#include <QDBusPendingReply>
+#include <QHash>
 #include <QList>
 #include <QString>
 #include <QTimer>
+#include <QVarLengthArray>
 
 namespace KDNSSD
 {
@@ -32,13 +38,47 @@ public:
     }
     ~ServiceBrowserPrivate() override
     {
+        for (const Entry &entry : std::as_const(m_services.entries)) {
+            if (entry.resolving) {
+                ResolveScheduler::self()->cancel(entry.service);
+            }
+        }
         if (m_browser) {
-            m_browser->Free();
+            freeAvahiObject(m_browser);
         }
         delete m_browser;
     }
-    QList<RemoteService::Ptr> m_services;
-    QList<RemoteService::Ptr> m_duringResolve;
+
+    struct AvahiInstance {
+        int interface;
+        int protocol;
+        bool operator==(const AvahiInstance &) const = default;
+    };
+    struct Entry {
+        // null for services not asked for yet in record mode, the const
+        // accessors of ServiceBrowser create it on demand
+        mutable RemoteService::Ptr service;
+        // we get the same service once per interface and protocol it is seen on
+        QVarLengthArray<AvahiInstance, 2> instances;
+        bool resolving = false;
+        // see BrowsedServices
+        quint64 found = 0;
+    };
+    BrowsedServices<Entry> m_services;
+    int m_resolving = 0;
+    bool m_recordMode = false;
+
+    // creates the service object of a record mode entry on first use
+    static RemoteService::Ptr serviceFor(const Entry &entry, const ServiceKey &key);
+
+    ServiceBatch m_batch;
+    QTimer m_batchTimer;
+
+    // emit the per-service signal and queue the service for the batched one
+    void reportAdded(const RemoteService::Ptr &svr);
+    void reportRemoved(const RemoteService::Ptr &svr);
+    void flushBatch();
+
     QString m_type;
     QString m_domain;
     QString m_subtype;
@@ -46,23 +86,40 @@ public:
     bool m_running = false;
     bool m_finished = false;
     bool m_browserFinished = false;
+    // Set while browsing again after the daemon restarted. Entries the new
+    // browser does not report again until it is done are removed then.
+    bool m_recovering = false;
+    bool m_paused = false;
+    // Bumped whenever the browser is released, a browser created for an
+    // older one is freed right away.
+    quint64 m_generation = 0;
     QTimer m_timer;
     org::freedesktop::Avahi::ServiceBrowser *m_browser = nullptr;
     ServiceBrowser *m_parent = nullptr;
 
-    // get already found service identical to s or null if not found
-    RemoteService::Ptr find(RemoteService::Ptr s, const QList<RemoteService::Ptr> &where) const;
+    void createBrowser(quint64 generation);
+    // prepared browsers still have to be started
+    void browserCreated(const QDBusPendingReply<QDBusObjectPath> &rep, bool prepared);
+    void handleSignal(const QDBusMessage &msg) override;
+    QString avahiInterface() const override
+    {
+        return QStringLiteral("org.freedesktop.Avahi.ServiceBrowser");
+    }
+
+private:
+    void serviceResolved(const ServiceKey &key, bool success);
+    void removeEntry(QHash<ServiceKey, Entry>::iterator it);
+    // Detaches from the daemon-side browser, free is false if it is gone
+    // already. Services still being resolved are dropped, they are found
+    // again by the next browser.
+    void releaseBrowser(bool free);
+    // browses anew, reporting only the differences to the services known
+    void resync();
+    void daemonRestarted();
 
 private Q_SLOTS:
     void browserFinished();
     void queryFinished();
-    void serviceResolved(bool success);
-
-    // NB: The global slots are runtime connected! If their signature changes
-    // make sure the SLOT() signature gets updated!
-    void gotGlobalItemNew(int interface, int protocol, const QString &name, const QString &type, const QString &domain, uint flags, QDBusMessage msg);
-    void gotGlobalItemRemove(int interface, int protocol, const QString &name, const QString &type, const QString &domain, uint flags, QDBusMessage msg);
-    void gotGlobalAllForNow(QDBusMessage msg);
 
     void gotNewService(int, int, const QString &, const QString &, const QString &, uint);
     void gotRemoveService(int, int, const QString &, const QString &, const QString &, uint);
@@ -12,6 +12,7 @@
 #include "avahi_servicetypebrowser_interface.h"
 #include "servicetypebrowser.h"
 #include <QSet>
+#include <utility>
 
 #define UNSPEC -1
 namespace KDNSSD
@@ -23,6 +24,8 @@ ServiceTypeBrowser::ServiceTypeBrowser(const QString &domain, QObject *parent)
     Q_D(ServiceTypeBrowser);
     d->m_domain = domain;
     d->m_timer.setSingleShot(true);
+    connect(&d->m_timer, SIGNAL(timeout()), d, SLOT(finished()));
+    connect(AvahiSignalDispatcher::self(), &AvahiSignalDispatcher::daemonRestarted, d, &ServiceTypeBrowserPrivate::daemonRestarted);
 }
 
 ServiceTypeBrowser::~ServiceTypeBrowser() = default;
@@ -34,80 +37,139 @@ void ServiceTypeBrowser::startBrowse()
         return;
     }
     d->m_started = true;
+    d->createBrowser();
+}
+
+void ServiceTypeBrowserPrivate::createBrowser()
+{
+    setObjectPath(QString());
+    // how to create the browser depends on the version of the daemon
+    AvahiSignalDispatcher::self()->whenReady(this, [this, generation = m_generation] {
+        if (generation == m_generation) {
+            createBrowserNow();
+        }
+    });
+}
 
-    // Do not race!
-    // https://github.com/lathiat/avahi/issues/9
-    // Avahi's DBus API is incredibly racey with signals getting fired
-    // immediately after a request was made even though we may not yet be
-    // listening. In lieu of a proper upstream fix for this we'll unfortunately
-    // have to resort to this hack:
-    // We register to all signals regardless of path and then filter them once
-    // we know what "our" path is. This is much more fragile than a proper
-    // QDBusInterface assisted signal connection but unfortunately the only way
-    // we can reliably prevent signals getting lost in the race.
-    // This uses a fancy trick whereby using QDBusMessage as last argument will
-    // give us the correct signal argument types as well as the underlying
-    // message so that we may check the message path.
-    QDBusConnection::systemBus().connect("org.freedesktop.Avahi",
-                                         "",
-                                         "org.freedesktop.Avahi.ServiceTypeBrowser",
-                                         "ItemNew",
-                                         d,
-                                         SLOT(gotGlobalItemNew(int, int, QString, QString, uint, QDBusMessage)));
-    QDBusConnection::systemBus().connect("org.freedesktop.Avahi",
-                                         "",
-                                         "org.freedesktop.Avahi.ServiceTypeBrowser",
-                                         "ItemRemove",
-                                         d,
-                                         SLOT(gotGlobalItemRemove(int, int, QString, QString, uint, QDBusMessage)));
-    QDBusConnection::systemBus()
-        .connect("org.freedesktop.Avahi", "", "org.freedesktop.Avahi.ServiceTypeBrowser", "AllForNow", d, SLOT(gotGlobalAllForNow(QDBusMessage)));
-    d->m_dbusObjectPath.clear();
-
-    org::freedesktop::Avahi::Server s(QStringLiteral("org.freedesktop.Avahi"), QStringLiteral("/"), QDBusConnection::systemBus());
-
-    QDBusReply<QDBusObjectPath> rep = s.ServiceTypeBrowserNew(-1, -1, d->m_domain, 0);
+void ServiceTypeBrowserPrivate::createBrowserNow()
+{
+    // Make sure we are subscribed before the browser exists. Unless it is
+    // only prepared, its signals may arrive before the reply carrying its
+    // path.
+    AvahiListener::subscribe();
+
+    OrgFreedesktopAvahiServerInterface *s = avahiServer();
+
+    const bool prepare = AvahiSignalDispatcher::self()->usePrepare();
+    QDBusReply<QDBusObjectPath> rep = prepare ? s->ServiceTypeBrowserPrepare(-1, -1, m_domain, 0) : s->ServiceTypeBrowserNew(-1, -1, m_domain, 0);
     if (!rep.isValid()) {
         return;
     }
 
-    d->m_dbusObjectPath = rep.value().path();
+    setObjectPath(rep.value().path());
 
     // This is held because we need to explicitly Free it!
-    d->m_browser = new org::freedesktop::Avahi::ServiceTypeBrowser(s.service(), d->m_dbusObjectPath, s.connection());
+    m_browser = new org::freedesktop::Avahi::ServiceTypeBrowser(s->service(), m_dbusObjectPath, s->connection());
+    if (prepare) {
+        startAvahiObject(m_browser);
+    }
 
-    connect(&d->m_timer, SIGNAL(timeout()), d, SLOT(finished()));
-    d->m_timer.start(domainIsLocal(d->m_domain) ? TIMEOUT_LAST_SERVICE : TIMEOUT_START_WAN);
+    m_timer.start(domainIsLocal(m_domain) ? TIMEOUT_LAST_SERVICE : TIMEOUT_START_WAN);
 }
 
-void ServiceTypeBrowserPrivate::finished()
+void ServiceTypeBrowser::stopBrowse()
 {
-    m_timer.stop();
-    Q_EMIT m_parent->finished();
+    Q_D(ServiceTypeBrowser);
+    if (!d->m_started) {
+        return;
+    }
+    d->releaseBrowser(true);
+    d->m_servicetypes.clear();
+    d->m_stale.clear();
+    d->m_started = false;
+    d->m_paused = false;
 }
 
-void ServiceTypeBrowserPrivate::gotGlobalItemNew(int interface, int protocol, const QString &type, const QString &domain, uint flags, QDBusMessage msg)
+void ServiceTypeBrowser::pause()
 {
-    if (!isOurMsg(msg)) {
+    Q_D(ServiceTypeBrowser);
+    if (!d->m_started || d->m_paused) {
         return;
     }
-    gotNewServiceType(interface, protocol, type, domain, flags);
+    d->releaseBrowser(true);
+    d->m_paused = true;
 }
 
-void ServiceTypeBrowserPrivate::gotGlobalItemRemove(int interface, int protocol, const QString &type, const QString &domain, uint flags, QDBusMessage msg)
+void ServiceTypeBrowser::resume()
 {
-    if (!isOurMsg(msg)) {
+    Q_D(ServiceTypeBrowser);
+    if (!d->m_paused) {
         return;
     }
-    gotRemoveServiceType(interface, protocol, type, domain, flags);
+    d->m_paused = false;
+    d->resync();
+}
+
+bool ServiceTypeBrowser::isPaused() const
+{
+    Q_D(const ServiceTypeBrowser);
+    return d->m_paused;
 }
 
-void ServiceTypeBrowserPrivate::gotGlobalAllForNow(QDBusMessage msg)
+void ServiceTypeBrowserPrivate::releaseBrowser(bool free)
 {
-    if (!isOurMsg(msg)) {
+    ++m_generation;
+    m_timer.stop();
+    if (m_browser && free) {
+        freeAvahiObject(m_browser);
+    }
+    delete m_browser;
+    m_browser = nullptr;
+    setObjectPath(QString());
+}
+
+void ServiceTypeBrowserPrivate::resync()
+{
+    // keep the types and only report those the new browser does not find
+    for (const AvahiServiceType &s : std::as_const(m_servicetypes)) {
+        m_stale.insert(s.type);
+    }
+    m_servicetypes.clear();
+    createBrowser();
+}
+
+void ServiceTypeBrowserPrivate::daemonRestarted()
+{
+    if (!m_started || m_paused) {
         return;
     }
-    finished();
+    // The browser died with the daemon, and its path may belong to
+    // someone else by now, so it must not be freed.
+    releaseBrowser(false);
+    resync();
+}
+
+void ServiceTypeBrowserPrivate::finished()
+{
+    m_timer.stop();
+    const QSet<QString> gone = std::exchange(m_stale, {});
+    for (const QString &type : gone) {
+        Q_EMIT m_parent->serviceTypeRemoved(type);
+    }
+    Q_EMIT m_parent->finished();
+}
+
+void ServiceTypeBrowserPrivate::handleSignal(const QDBusMessage &msg)
+{
+    const QList<QVariant> args = msg.arguments();
+    const QString member = msg.member();
+    if (member == QLatin1String("ItemNew") && args.size() == 5) {
+        gotNewServiceType(args.at(0).toInt(), args.at(1).toInt(), args.at(2).toString(), args.at(3).toString(), args.at(4).toUInt());
+    } else if (member == QLatin1String("ItemRemove") && args.size() == 5) {
+        gotRemoveServiceType(args.at(0).toInt(), args.at(1).toInt(), args.at(2).toString(), args.at(3).toString(), args.at(4).toUInt());
+    } else if (member == QLatin1String("AllForNow")) {
+        finished();
+    }
 }
 
 void ServiceTypeBrowserPrivate::gotNewServiceType(int interface, int protocol, const QString &type, const QString &domain, [[maybe_unused]] uint flags)
@@ -121,7 +183,8 @@ void ServiceTypeBrowserPrivate::gotNewServiceType(int interface, int protocol, c
                                               })
         == m_servicetypes.end();
     m_servicetypes.emplace_back(interface, protocol, type, domain);
-    if (newType) {
+    // known from before the daemon restarted already
+    if (newType && !m_stale.remove(type)) {
         Q_EMIT m_parent->serviceTypeAdded(type);
     }
 }
@@ -152,6 +215,9 @@ QStringList ServiceTypeBrowser::serviceTypes() const
             types.push_back(s.type);
         }
     }
+    for (const QString &type : d->m_stale) {
+        types.push_back(type);
+    }
     return types;
 }
 
@@ -12,6 +12,7 @@
 #include "avahi_listener_p.h"
 #include "avahi_servicetypebrowser_interface.h"
 #include "servicetypebrowser.h"
+#include <QSet>
 #include <QStringList>
 #include <QTimer>
 
@@ -30,13 +31,14 @@ public:
     ~ServiceTypeBrowserPrivate() override
     {
         if (m_browser) {
-            m_browser->Free();
+            freeAvahiObject(m_browser);
         }
     }
 
     org::freedesktop::Avahi::ServiceTypeBrowser *m_browser = nullptr;
     ServiceTypeBrowser *m_parent = nullptr;
     bool m_started = false;
+    bool m_paused = false;
 
     struct AvahiServiceType {
         int interface;
@@ -46,17 +48,30 @@ public:
         bool operator==(const AvahiServiceType &) const = default;
     };
     std::vector<AvahiServiceType> m_servicetypes;
+    // types reported before the daemon restarted or browsing was paused
+    // that the new browser has not found again yet, removed once it is done
+    QSet<QString> m_stale;
 
     QString m_domain;
     QTimer m_timer;
+    // Bumped whenever the browser is released, a browser that is still to
+    // be created for an older one is not.
+    quint64 m_generation = 0;
 
-private Q_SLOTS:
-    // NB: The global slots are runtime connected! If their signature changes
-    // make sure the SLOT() signature gets updated!
-    void gotGlobalItemNew(int interface, int protocol, const QString &type, const QString &domain, uint flags, QDBusMessage msg);
-    void gotGlobalItemRemove(int interface, int protocol, const QString &type, const QString &domain, uint flags, QDBusMessage msg);
-    void gotGlobalAllForNow(QDBusMessage msg);
+    void createBrowser();
+    void createBrowserNow();
+    // detaches from the daemon-side browser, free is false if it is gone already
+    void releaseBrowser(bool free);
+    // browses anew, reporting only the differences to the types known
+    void resync();
+    void daemonRestarted();
+    void handleSignal(const QDBusMessage &msg) override;
+    QString avahiInterface() const override
+    {
+        return QStringLiteral("org.freedesktop.Avahi.ServiceTypeBrowser");
+    }
 
+private Q_SLOTS:
     void gotNewServiceType(int, int, const QString &, const QString &, uint);
     void gotRemoveServiceType(int, int, const QString &, const QString &, uint);
     void finished();
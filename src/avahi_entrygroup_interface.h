@@ -13,6 +13,7 @@
 
 #include <QDBusAbstractInterface>
 #include <QDBusConnection>
+#include <QDBusPendingReply>
 #include <QDBusReply>
 #include <QList>
 #include <QMap>
@@ -73,6 +74,24 @@ public Q_SLOTS: // METHODS
         return callWithArgumentList(QDBus::Block, QLatin1String("AddService"), argumentList);
     }
 
+    // HAND-EDIT: non-blocking variant, the reply is collected by the caller
+    inline QDBusPendingReply<> AddServiceAsync(int interface,
+                                               int protocol,
+                                               uint flags,
+                                               const QString &name,
+                                               const QString &type,
+                                               const QString &domain,
+                                               const QString &host,
+                                               ushort port,
+                                               const QList<QByteArray> &txt)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(interface) << QVariant::fromValue(protocol) << QVariant::fromValue(flags) << QVariant::fromValue(name)
+                     << QVariant::fromValue(type) << QVariant::fromValue(domain) << QVariant::fromValue(host) << QVariant::fromValue(port)
+                     << QVariant::fromValue(txt);
+        return asyncCallWithArgumentList(QLatin1String("AddService"), argumentList);
+    }
+
     inline QDBusReply<void>
     AddServiceSubtype(int interface, int protocol, uint flags, const QString &name, const QString &type, const QString &domain, const QString &subtype)
     {
@@ -82,12 +101,28 @@ public Q_SLOTS: // METHODS
         return callWithArgumentList(QDBus::Block, QLatin1String("AddServiceSubtype"), argumentList);
     }
 
+    // HAND-EDIT: non-blocking variant, the reply is collected by the caller
+    inline QDBusPendingReply<>
+    AddServiceSubtypeAsync(int interface, int protocol, uint flags, const QString &name, const QString &type, const QString &domain, const QString &subtype)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(interface) << QVariant::fromValue(protocol) << QVariant::fromValue(flags) << QVariant::fromValue(name)
+                     << QVariant::fromValue(type) << QVariant::fromValue(domain) << QVariant::fromValue(subtype);
+        return asyncCallWithArgumentList(QLatin1String("AddServiceSubtype"), argumentList);
+    }
+
     inline QDBusReply<void> Commit()
     {
         QList<QVariant> argumentList;
         return callWithArgumentList(QDBus::Block, QLatin1String("Commit"), argumentList);
     }
 
+    // HAND-EDIT: non-blocking variant, the reply is collected by the caller
+    inline QDBusPendingReply<> CommitAsync()
+    {
+        return asyncCallWithArgumentList(QLatin1String("Commit"), QList<QVariant>());
+    }
+
     inline QDBusReply<void> Free()
     {
         QList<QVariant> argumentList;
@@ -112,6 +147,12 @@ public Q_SLOTS: // METHODS
         return callWithArgumentList(QDBus::Block, QLatin1String("Reset"), argumentList);
     }
 
+    // HAND-EDIT: non-blocking variant, the reply is collected by the caller
+    inline QDBusPendingReply<> ResetAsync()
+    {
+        return asyncCallWithArgumentList(QLatin1String("Reset"), QList<QVariant>());
+    }
+
     inline QDBusReply<void>
     UpdateServiceTxt(int interface, int protocol, uint flags, const QString &name, const QString &type, const QString &domain, const QList<QByteArray> &txt)
     {
@@ -121,6 +162,16 @@ public Q_SLOTS: // METHODS
         return callWithArgumentList(QDBus::Block, QLatin1String("UpdateServiceTxt"), argumentList);
     }
 
+    // HAND-EDIT: non-blocking variant, the reply is collected by the caller
+    inline QDBusPendingReply<>
+    UpdateServiceTxtAsync(int interface, int protocol, uint flags, const QString &name, const QString &type, const QString &domain, const QList<QByteArray> &txt)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(interface) << QVariant::fromValue(protocol) << QVariant::fromValue(flags) << QVariant::fromValue(name)
+                     << QVariant::fromValue(type) << QVariant::fromValue(domain) << QVariant::fromValue(txt);
+        return asyncCallWithArgumentList(QLatin1String("UpdateServiceTxt"), argumentList);
+    }
+
 Q_SIGNALS: // SIGNALS
     void StateChanged(int state, const QString &error);
 };
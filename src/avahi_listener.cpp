@@ -8,14 +8,274 @@
 
 #include "avahi_listener_p.h"
 
+#include "avahi_server_interface.h"
+#include "kdnssd_debug.h"
+
+#include <QDBusConnection>
+#include <QDBusPendingCallWatcher>
+#include <QDBusServiceWatcher>
+#include <QThreadStorage>
+
+#include <utility>
+
 namespace KDNSSD
 {
+static QThreadStorage<AvahiSignalDispatcher *> s_dispatchers;
+
 AvahiListener::AvahiListener()
 {
 }
 
 AvahiListener::~AvahiListener()
 {
+    setObjectPath(QString());
+}
+
+void AvahiListener::subscribe()
+{
+    AvahiSignalDispatcher::self();
+}
+
+void AvahiListener::setObjectPath(const QString &path)
+{
+    if (path == m_dbusObjectPath) {
+        return;
+    }
+    if (!m_dbusObjectPath.isEmpty() && m_dispatcher) {
+        m_dispatcher->removeListener(m_dbusObjectPath, this);
+    }
+    m_dispatcher = nullptr;
+    m_dbusObjectPath = path;
+    if (!m_dbusObjectPath.isEmpty()) {
+        m_dispatcher = AvahiSignalDispatcher::self();
+        m_dispatcher->addListener(m_dbusObjectPath, this);
+    }
+}
+
+// All signals emitted by the Avahi objects we create.
+static const struct {
+    const char *interface;
+    const char *name;
+} signalKinds[] = {
+    {"org.freedesktop.Avahi.ServiceBrowser", "ItemNew"},
+    {"org.freedesktop.Avahi.ServiceBrowser", "ItemRemove"},
+    {"org.freedesktop.Avahi.ServiceBrowser", "AllForNow"},
+    {"org.freedesktop.Avahi.ServiceBrowser", "Failure"},
+    {"org.freedesktop.Avahi.ServiceTypeBrowser", "ItemNew"},
+    {"org.freedesktop.Avahi.ServiceTypeBrowser", "ItemRemove"},
+    {"org.freedesktop.Avahi.ServiceTypeBrowser", "AllForNow"},
+    {"org.freedesktop.Avahi.ServiceTypeBrowser", "Failure"},
+    {"org.freedesktop.Avahi.DomainBrowser", "ItemNew"},
+    {"org.freedesktop.Avahi.DomainBrowser", "ItemRemove"},
+    {"org.freedesktop.Avahi.DomainBrowser", "AllForNow"},
+    {"org.freedesktop.Avahi.DomainBrowser", "Failure"},
+    {"org.freedesktop.Avahi.ServiceResolver", "Found"},
+    {"org.freedesktop.Avahi.ServiceResolver", "Failure"},
+    {"org.freedesktop.Avahi.EntryGroup", "StateChanged"},
+};
+
+// GetAPIVersion of Avahi 0.8, the first release with the *Prepare calls
+static const uint s_prepareApiVersion = 0x0203;
+// how many signals of an object are held back at most while it is being created
+static const qsizetype s_maxEarly = 256;
+
+AvahiSignalDispatcher::AvahiSignalDispatcher()
+{
+    auto watcher =
+        new QDBusServiceWatcher(QStringLiteral("org.freedesktop.Avahi"), QDBusConnection::systemBus(), QDBusServiceWatcher::WatchForOwnerChange, this);
+    connect(watcher, &QDBusServiceWatcher::serviceOwnerChanged, this, &AvahiSignalDispatcher::ownerChanged);
+
+    detectApiVersion();
+}
+
+AvahiSignalDispatcher::~AvahiSignalDispatcher()
+{
+}
+
+AvahiSignalDispatcher *AvahiSignalDispatcher::self()
+{
+    if (!s_dispatchers.hasLocalData()) {
+        s_dispatchers.setLocalData(new AvahiSignalDispatcher);
+    }
+    return s_dispatchers.localData();
+}
+
+void AvahiSignalDispatcher::addListener(const QString &path, AvahiListener *listener)
+{
+    m_listeners.insert(path, listener);
+    if (m_perPath) {
+        setSubscribed(path, listener->avahiInterface(), true);
+    }
+    const QList<QDBusMessage> replay = m_early.take(path);
+    for (const QDBusMessage &msg : replay) {
+        // the listener may go away while handling one of them
+        if (m_listeners.value(path) != listener) {
+            break;
+        }
+        listener->handleSignal(msg);
+    }
+}
+
+void AvahiSignalDispatcher::removeListener(const QString &path, AvahiListener *listener)
+{
+    auto it = m_listeners.find(path);
+    if (it != m_listeners.end() && it.value() == listener) {
+        m_listeners.erase(it);
+        if (m_perPath) {
+            setSubscribed(path, listener->avahiInterface(), false);
+        }
+    }
+}
+
+void AvahiSignalDispatcher::beginCreate(const QString &interface)
+{
+    ++m_pendingCreates[interface];
+}
+
+void AvahiSignalDispatcher::endCreate(const QString &interface)
+{
+    auto it = m_pendingCreates.find(interface);
+    if (it == m_pendingCreates.end() || --it.value() > 0) {
+        return;
+    }
+    m_pendingCreates.erase(it);
+    // all signals of a path are of the same interface
+    m_early.removeIf([&interface](QHash<QString, QList<QDBusMessage>>::iterator it) {
+        return it->constFirst().interface() == interface;
+    });
+}
+
+void AvahiSignalDispatcher::whenReady(QObject *context, const std::function<void()> &fn)
+{
+    if (m_apiWatcher) {
+        m_ready.append({context, fn});
+    } else {
+        fn();
+    }
+}
+
+bool AvahiSignalDispatcher::usePrepare() const
+{
+    Q_ASSERT(!m_apiWatcher);
+    return m_perPath;
+}
+
+void AvahiSignalDispatcher::detectApiVersion()
+{
+    delete m_apiWatcher;
+    m_apiWatcher = new QDBusPendingCallWatcher(avahiServer()->GetAPIVersionAsync(), this);
+    connect(m_apiWatcher, &QDBusPendingCallWatcher::finished, this, &AvahiSignalDispatcher::apiVersionReceived);
+}
+
+void AvahiSignalDispatcher::apiVersionReceived()
+{
+    const QDBusPendingReply<uint> rep = *m_apiWatcher;
+    m_apiWatcher->deleteLater();
+    m_apiWatcher = nullptr;
+
+    // Without a daemon we cannot tell, stay on the safe side. We get here
+    // again once it is started.
+    m_perPath = rep.isValid() && rep.value() >= s_prepareApiVersion;
+    qCDebug(KDNSSD_LOG) << "Using" << (m_perPath ? "per-path" : "wildcard") << "match rules for Avahi signals";
+
+    // Objects are only created once we get here, and those of a previous
+    // daemon are gone with it, so the subscriptions can be swapped without
+    // losing or doubling any signal.
+    if (m_wildcard == m_perPath) {
+        m_wildcard = !m_perPath;
+        setSubscribed(QString(), QString(), m_wildcard);
+    }
+
+    // Listeners re-create their objects right away now. They are told
+    // before the callbacks run, an object created by one of those belongs
+    // to the new daemon already and must not be re-created.
+    if (std::exchange(m_restarted, false)) {
+        Q_EMIT daemonRestarted();
+    }
+
+    const auto ready = std::exchange(m_ready, {});
+    for (const auto &[context, fn] : ready) {
+        if (context) {
+            fn();
+        }
+    }
+}
+
+void AvahiSignalDispatcher::setSubscribed(const QString &path, const QString &interface, bool subscribed)
+{
+    // Using QDBusMessage as the only argument gives us every signal of the
+    // given name regardless of its argument types, together with the path
+    // we need for routing.
+    QDBusConnection bus = QDBusConnection::systemBus();
+    for (const auto &kind : signalKinds) {
+        if (!interface.isEmpty() && interface != QLatin1String(kind.interface)) {
+            continue;
+        }
+        if (subscribed) {
+            bus.connect(QStringLiteral("org.freedesktop.Avahi"),
+                        path,
+                        QLatin1String(kind.interface),
+                        QLatin1String(kind.name),
+                        this,
+                        SLOT(dispatch(QDBusMessage)));
+        } else {
+            bus.disconnect(QStringLiteral("org.freedesktop.Avahi"),
+                           path,
+                           QLatin1String(kind.interface),
+                           QLatin1String(kind.name),
+                           this,
+                           SLOT(dispatch(QDBusMessage)));
+        }
+    }
+}
+
+void AvahiSignalDispatcher::dispatch(const QDBusMessage &msg)
+{
+    AvahiListener *listener = m_listeners.value(msg.path());
+    if (listener) {
+        listener->handleSignal(msg);
+    } else if (m_pendingCreates.contains(msg.interface())) {
+        // With wildcard rules we see the objects of every other client as
+        // well. A burst of those must not pile up while we wait for a reply,
+        // nor push out the signals of our own objects, so the limit is per
+        // path.
+        QList<QDBusMessage> &early = m_early[msg.path()];
+        if (early.size() == s_maxEarly) {
+            early.removeFirst();
+        }
+        early.append(msg);
+    }
+}
+
+void AvahiSignalDispatcher::ownerChanged(const QString &, const QString &, const QString &newOwner)
+{
+    // Every path we know died with the old daemon. The new one hands out
+    // the same paths again, they must not reach the listeners of the old.
+    if (m_perPath) {
+        for (auto it = m_listeners.cbegin(); it != m_listeners.cend(); ++it) {
+            setSubscribed(it.key(), it.value()->avahiInterface(), false);
+        }
+    }
+    m_listeners.clear();
+    m_early.clear();
+    if (!newOwner.isEmpty()) {
+        // it may be a different version, our objects are created once we know
+        m_restarted = true;
+        detectApiVersion();
+    }
+}
+
+void freeAvahiObject(const QString &path, const QString &interface)
+{
+    QDBusConnection::systemBus().send(QDBusMessage::createMethodCall(QStringLiteral("org.freedesktop.Avahi"), path, interface, QStringLiteral("Free")));
+}
+
+void startAvahiObject(const QDBusAbstractInterface *object)
+{
+    QDBusConnection::systemBus().send(
+        QDBusMessage::createMethodCall(QStringLiteral("org.freedesktop.Avahi"), object->path(), object->interface(), QStringLiteral("Start")));
 }
 
 } // namespace KDNSSD
+
+#include "moc_avahi_listener_p.cpp"
@@ -9,34 +9,152 @@
 #ifndef AVAHILISTENER_H
 #define AVAHILISTENER_H
 
+#include <QDBusAbstractInterface>
 #include <QDBusMessage>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
 #include <QString>
 
+#include <functional>
+
+class QDBusPendingCallWatcher;
+
 namespace KDNSSD
 {
-// Assists with listening to Avahi for all signals and then checking if the
-// a given dbus message is meant for us or not.
-// Subclass and set the object path to object path you should be listening to.
-// Messages may then be run through isOurMsg to determine if they target the
-// object at hand.
+class AvahiSignalDispatcher;
+
+// Receives the Avahi signals of exactly one daemon-side object.
+// Subclass and set the object path you should be listening to via
+// setObjectPath(). All signals emitted by the object at that path are then
+// routed to handleSignal() by the AvahiSignalDispatcher of the thread
+// setObjectPath() was called in.
 class AvahiListener
 {
 public:
     explicit AvahiListener();
     virtual ~AvahiListener();
 
-    // This method gets called a lot but doesn't do much. Suggest inlining.
-    inline bool isOurMsg(const QDBusMessage &msg) const
-    {
-        if (m_dbusObjectPath.isEmpty() || m_dbusObjectPath != msg.path()) {
-            return false;
-        }
-        return true;
-    }
+    // Makes sure the process wide signal subscriptions are in place. Call this
+    // before asking Avahi to create an object so that no signal is lost.
+    static void subscribe();
+
+    // Assigns the object path of our daemon-side object. Passing an empty
+    // path detaches the listener, e.g. after the object was freed.
+    void setObjectPath(const QString &path);
+
+    // Called for every signal emitted by the object at m_dbusObjectPath.
+    virtual void handleSignal(const QDBusMessage &msg) = 0;
+
+    // The D-Bus interface of our daemon-side object. With per-path match
+    // rules only the signals of this interface are subscribed to.
+    virtual QString avahiInterface() const = 0;
 
-    QString m_dbusObjectPath; // public so !Private objects can access it
+    QString m_dbusObjectPath; // public so !Private objects can access it, use setObjectPath() to change it
+
+private:
+    // the dispatcher we are registered with, gone once its thread finished
+    QPointer<AvahiSignalDispatcher> m_dispatcher;
 };
 
+// Do not race!
+// https://github.com/lathiat/avahi/issues/9
+// Avahi's DBus API is incredibly racey with signals getting fired
+// immediately after a request was made even though we may not yet be
+// listening. In lieu of a proper upstream fix for this we'll unfortunately
+// have to resort to this hack:
+// We register to all signals regardless of path and then route them once
+// we know what "our" path is. To not have every listener look at every
+// message there is only one subscription per signal kind in the process and
+// messages are dispatched to their listener by object path.
+//
+// That fix arrived with Avahi 0.8: objects created with the *Prepare calls
+// stay silent until they are started, which leaves us the time to add match
+// rules for their path only. Wildcard rules wake this process for the
+// browse traffic of every other client on the system, so they are only used
+// when GetAPIVersion tells us the daemon is older.
+//
+// There is one dispatcher per thread. QtDBus delivers the signals in the
+// thread of the dispatcher, so listeners are called in the thread they live
+// in and neither side needs locking. Objects are expected to stay in the
+// thread they were created in.
+class AvahiSignalDispatcher : public QObject
+{
+    Q_OBJECT
+public:
+    AvahiSignalDispatcher();
+    ~AvahiSignalDispatcher() override;
+
+    // The dispatcher of the calling thread, made on first use.
+    static AvahiSignalDispatcher *self();
+
+    void addListener(const QString &path, AvahiListener *listener);
+    void removeListener(const QString &path, AvahiListener *listener);
+
+    // Brackets an asynchronous request creating an Avahi object of the given
+    // D-Bus interface. While any such request is in flight, signals of that
+    // interface for paths nobody listens to yet are held back and replayed
+    // once a listener for their path is added.
+    void beginCreate(const QString &interface);
+    void endCreate(const QString &interface);
+
+    // Runs fn once the API version of the daemon is known, right away if it
+    // is already. Asynchronous object creation has to go through this, the
+    // answer decides both how to create objects and how to subscribe.
+    void whenReady(QObject *context, const std::function<void()> &fn);
+
+    // Whether objects are to be created with the *Prepare calls and started
+    // by startAvahiObject() once their path is set. Only known from within
+    // a whenReady() callback.
+    bool usePrepare() const;
+
+Q_SIGNALS:
+    // avahi-daemon came (back) up and its API version is known. All objects
+    // of the previous instance are gone, listeners have to create theirs
+    // anew.
+    void daemonRestarted();
+
+private Q_SLOTS:
+    // NB: This slot is runtime connected! If its signature changes
+    // make sure the SLOT() signature gets updated!
+    void dispatch(const QDBusMessage &msg);
+    void ownerChanged(const QString &service, const QString &oldOwner, const QString &newOwner);
+
+private:
+    void detectApiVersion();
+    void apiVersionReceived();
+    // Adds or removes the match rules for path, an empty path and interface
+    // stand for the wildcard rules.
+    void setSubscribed(const QString &path, const QString &interface, bool subscribed);
+
+    QHash<QString, AvahiListener *> m_listeners;
+    // signals held back per path, the oldest ones are dropped beyond s_maxEarly
+    QHash<QString, QList<QDBusMessage>> m_early;
+    // requests in flight per interface
+    QHash<QString, int> m_pendingCreates;
+    QDBusPendingCallWatcher *m_apiWatcher = nullptr;
+    QList<std::pair<QPointer<QObject>, std::function<void()>>> m_ready;
+    bool m_perPath = false;
+    bool m_wildcard = false;
+    // daemonRestarted() is due once the version of the new daemon is known
+    bool m_restarted = false;
+};
+
+// Frees the daemon-side object at path without waiting for the reply.
+// Teardown must not stall on daemon round trips, and there is nothing left
+// to do should freeing fail.
+void freeAvahiObject(const QString &path, const QString &interface);
+inline void freeAvahiObject(const QDBusAbstractInterface *object)
+{
+    freeAvahiObject(object->path(), object->interface());
+}
+
+// Starts an object created with one of the *Prepare calls. Only call this
+// after setObjectPath(), the match rules for the path are sent ahead of it
+// and therefore in place before the object emits anything.
+void startAvahiObject(const QDBusAbstractInterface *object);
+
 } // namespace KDNSSD
 
 #endif // AVAHILISTENER_H
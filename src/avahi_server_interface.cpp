@@ -11,8 +11,18 @@
 
 #include "avahi_server_interface.h"
 #include "servicebase.h"
+#include <QCoreApplication>
 #include <QDBusMetaType>
+#include <QDBusPendingCallWatcher>
+#include <QDBusServiceWatcher>
+#include <QMutex>
+#include <QThread>
+#include <QThreadStorage>
 #include <QUrl>
+#include <avahi-common/defs.h>
+
+#include <atomic>
+#include <optional>
 /*
  * Implementation of interface class OrgFreedesktopAvahiServerInterface
  */
@@ -31,6 +41,123 @@ OrgFreedesktopAvahiServerInterface::~OrgFreedesktopAvahiServerInterface()
 
 namespace KDNSSD
 {
+// HAND-EDIT: one proxy per thread, so that its StateChanged signal reaches
+// the objects connected to it in the thread they live in
+static QThreadStorage<OrgFreedesktopAvahiServerInterface *> s_servers;
+
+OrgFreedesktopAvahiServerInterface *avahiServer()
+{
+    if (!s_servers.hasLocalData()) {
+        s_servers.setLocalData(
+            new OrgFreedesktopAvahiServerInterface(QStringLiteral("org.freedesktop.Avahi"), QStringLiteral("/"), QDBusConnection::systemBus()));
+    }
+    return s_servers.localData();
+}
+
+// HAND-EDIT: what we know about the daemon, unset means not asked for yet.
+// The signals of the daemon update it in the main thread, which outlives
+// the thread that happens to create it, while the getters below can be
+// called from any thread.
+struct ServerCache {
+    ServerCache();
+    void setHostName(const std::optional<QString> &name);
+    void refreshHostName();
+
+    // AVAHI_SERVER_INVALID and up are the states of the daemon
+    static constexpr int UnknownState = -1;
+
+    // also the context of our connections
+    QDBusServiceWatcher watcher;
+    // not avahiServer(), that one belongs to the creating thread
+    OrgFreedesktopAvahiServerInterface server;
+    std::atomic<int> state{UnknownState};
+    QMutex mutex;
+    // guarded by mutex
+    std::optional<QString> hostName;
+};
+
+Q_GLOBAL_STATIC(ServerCache, s_serverCache)
+
+ServerCache::ServerCache()
+    : watcher(QStringLiteral("org.freedesktop.Avahi"), QDBusConnection::systemBus(), QDBusServiceWatcher::WatchForOwnerChange)
+    , server(QStringLiteral("org.freedesktop.Avahi"), QStringLiteral("/"), QDBusConnection::systemBus())
+{
+    if (QCoreApplication *app = QCoreApplication::instance(); app && app->thread() != QThread::currentThread()) {
+        watcher.moveToThread(app->thread());
+        server.moveToThread(app->thread());
+    }
+    QObject::connect(&watcher, &QDBusServiceWatcher::serviceOwnerChanged, &watcher, [this](const QString &, const QString &, const QString &newOwner) {
+        if (newOwner.isEmpty()) {
+            state = AVAHI_SERVER_INVALID;
+            setHostName(QString());
+        } else {
+            // asked for again when needed
+            state = UnknownState;
+            setHostName(std::nullopt);
+        }
+    });
+    QObject::connect(&server, &OrgFreedesktopAvahiServerInterface::StateChanged, &watcher, [this](int newState) {
+        state = newState;
+        // the host name only changes while the server is registering
+        if (newState == AVAHI_SERVER_RUNNING) {
+            refreshHostName();
+        }
+    });
+}
+
+void ServerCache::setHostName(const std::optional<QString> &name)
+{
+    QMutexLocker locker(&mutex);
+    hostName = name;
+}
+
+void ServerCache::refreshHostName()
+{
+    auto pending = new QDBusPendingCallWatcher(server.GetHostNameAsync(), &watcher);
+    QObject::connect(pending, &QDBusPendingCallWatcher::finished, &watcher, [this](QDBusPendingCallWatcher *pending) {
+        pending->deleteLater();
+        const QDBusPendingReply<QString> rep = *pending;
+        if (rep.isValid()) {
+            setHostName(rep.value());
+        }
+    });
+}
+
+int avahiServerState()
+{
+    ServerCache *cache = s_serverCache();
+    int state = cache->state;
+    if (state == ServerCache::UnknownState) {
+        const QDBusReply<int> rep = avahiServer()->GetState();
+        // when there is no daemon we learn about it being started
+        const int received = rep.isValid() ? rep.value() : int(AVAHI_SERVER_INVALID);
+        // a StateChanged signal that came in meanwhile is more recent
+        if (cache->state.compare_exchange_strong(state, received)) {
+            state = received;
+        }
+    }
+    return state;
+}
+
+QString avahiHostName()
+{
+    ServerCache *cache = s_serverCache();
+    QMutexLocker locker(&cache->mutex);
+    if (!cache->hostName) {
+        // not holding the lock while blocking on the daemon
+        locker.unlock();
+        const QDBusReply<QString> rep = avahiServer()->GetHostName();
+        if (!rep.isValid()) {
+            return QString();
+        }
+        locker.relock();
+        if (!cache->hostName) {
+            cache->hostName = rep.value();
+        }
+    }
+    return *cache->hostName;
+}
+
 void registerTypes()
 {
     static bool registered = false;
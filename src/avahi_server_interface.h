@@ -13,6 +13,7 @@
 
 #include <QDBusAbstractInterface>
 #include <QDBusConnection>
+#include <QDBusPendingReply>
 #include <QDBusReply>
 #include <QList>
 #include <QMap>
@@ -59,18 +60,40 @@ public Q_SLOTS: // METHODS
         return callWithArgumentList(QDBus::Block, QLatin1String("DomainBrowserNew"), argumentList);
     }
 
+    // HAND-EDIT: since Avahi 0.8, the browser only emits signals once it is started
+    inline QDBusReply<QDBusObjectPath> DomainBrowserPrepare(int interface, int protocol, const QString &domain, int btype, uint flags)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(interface) << QVariant::fromValue(protocol) << QVariant::fromValue(domain) << QVariant::fromValue(btype)
+                     << QVariant::fromValue(flags);
+        return callWithArgumentList(QDBus::Block, QLatin1String("DomainBrowserPrepare"), argumentList);
+    }
+
     inline QDBusReply<QDBusObjectPath> EntryGroupNew()
     {
         QList<QVariant> argumentList;
         return callWithArgumentList(QDBus::Block, QLatin1String("EntryGroupNew"), argumentList);
     }
 
+    // HAND-EDIT: non-blocking variant, the reply is collected by the caller
+    inline QDBusPendingReply<QDBusObjectPath> EntryGroupNewAsync()
+    {
+        return asyncCallWithArgumentList(QLatin1String("EntryGroupNew"), QList<QVariant>());
+    }
+
     inline QDBusReply<uint> GetAPIVersion()
     {
         QList<QVariant> argumentList;
         return callWithArgumentList(QDBus::Block, QLatin1String("GetAPIVersion"), argumentList);
     }
 
+    // HAND-EDIT: non-blocking variant, the reply is collected by the caller
+    inline QDBusPendingReply<uint> GetAPIVersionAsync()
+    {
+        QList<QVariant> argumentList;
+        return asyncCallWithArgumentList(QLatin1String("GetAPIVersion"), argumentList);
+    }
+
     inline QDBusReply<QString> GetAlternativeHostName(const QString &name)
     {
         QList<QVariant> argumentList;
@@ -85,6 +108,14 @@ public Q_SLOTS: // METHODS
         return callWithArgumentList(QDBus::Block, QLatin1String("GetAlternativeServiceName"), argumentList);
     }
 
+    // HAND-EDIT: non-blocking variant, the reply is collected by the caller
+    inline QDBusPendingReply<QString> GetAlternativeServiceNameAsync(const QString &name)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(name);
+        return asyncCallWithArgumentList(QLatin1String("GetAlternativeServiceName"), argumentList);
+    }
+
     inline QDBusReply<QString> GetDomainName()
     {
         QList<QVariant> argumentList;
@@ -97,6 +128,12 @@ public Q_SLOTS: // METHODS
         return callWithArgumentList(QDBus::Block, QLatin1String("GetHostName"), argumentList);
     }
 
+    // HAND-EDIT: non-blocking variant, the reply is collected by the caller
+    inline QDBusPendingReply<QString> GetHostNameAsync()
+    {
+        return asyncCallWithArgumentList(QLatin1String("GetHostName"), QList<QVariant>());
+    }
+
     inline QDBusReply<QString> GetHostNameFqdn()
     {
         QList<QVariant> argumentList;
@@ -129,6 +166,12 @@ public Q_SLOTS: // METHODS
         return callWithArgumentList(QDBus::Block, QLatin1String("GetState"), argumentList);
     }
 
+    // HAND-EDIT: non-blocking variant, the reply is collected by the caller
+    inline QDBusPendingReply<int> GetStateAsync()
+    {
+        return asyncCallWithArgumentList(QLatin1String("GetState"), QList<QVariant>());
+    }
+
     inline QDBusReply<QString> GetVersionString()
     {
         QList<QVariant> argumentList;
@@ -205,6 +248,15 @@ public Q_SLOTS: // METHODS
         return reply;
     }
 
+    // HAND-EDIT: non-blocking variant, the reply is collected by the caller
+    inline QDBusPendingReply<int, int, QString, int, QString, uint> ResolveHostNameAsync(int interface, int protocol, const QString &name, int aprotocol, uint flags)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(interface) << QVariant::fromValue(protocol) << QVariant::fromValue(name) << QVariant::fromValue(aprotocol)
+                     << QVariant::fromValue(flags);
+        return asyncCallWithArgumentList(QLatin1String("ResolveHostName"), argumentList);
+    }
+
     inline QDBusReply<int> ResolveService(int interface,
                                           int protocol,
                                           const QString &name,
@@ -242,6 +294,17 @@ public Q_SLOTS: // METHODS
         return reply;
     }
 
+    // HAND-EDIT: non-blocking variant, the reply carries the same
+    // arguments as the ServiceResolver Found signal
+    inline QDBusPendingCall
+    ResolveServiceAsync(int interface, int protocol, const QString &name, const QString &type, const QString &domain, int aprotocol, uint flags)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(interface) << QVariant::fromValue(protocol) << QVariant::fromValue(name) << QVariant::fromValue(type)
+                     << QVariant::fromValue(domain) << QVariant::fromValue(aprotocol) << QVariant::fromValue(flags);
+        return asyncCallWithArgumentList(QLatin1String("ResolveService"), argumentList);
+    }
+
     inline QDBusReply<QDBusObjectPath> ServiceBrowserNew(int interface, int protocol, const QString &type, const QString &domain, uint flags)
     {
         QList<QVariant> argumentList;
@@ -250,6 +313,24 @@ public Q_SLOTS: // METHODS
         return callWithArgumentList(QDBus::Block, QLatin1String("ServiceBrowserNew"), argumentList);
     }
 
+    // HAND-EDIT: non-blocking variant, the reply is collected by the caller
+    inline QDBusPendingReply<QDBusObjectPath> ServiceBrowserNewAsync(int interface, int protocol, const QString &type, const QString &domain, uint flags)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(interface) << QVariant::fromValue(protocol) << QVariant::fromValue(type) << QVariant::fromValue(domain)
+                     << QVariant::fromValue(flags);
+        return asyncCallWithArgumentList(QLatin1String("ServiceBrowserNew"), argumentList);
+    }
+
+    // HAND-EDIT: since Avahi 0.8, the browser only emits signals once it is started
+    inline QDBusPendingReply<QDBusObjectPath> ServiceBrowserPrepareAsync(int interface, int protocol, const QString &type, const QString &domain, uint flags)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(interface) << QVariant::fromValue(protocol) << QVariant::fromValue(type) << QVariant::fromValue(domain)
+                     << QVariant::fromValue(flags);
+        return asyncCallWithArgumentList(QLatin1String("ServiceBrowserPrepare"), argumentList);
+    }
+
     inline QDBusReply<QDBusObjectPath>
     ServiceResolverNew(int interface, int protocol, const QString &name, const QString &type, const QString &domain, int aprotocol, uint flags)
     {
@@ -259,6 +340,16 @@ public Q_SLOTS: // METHODS
         return callWithArgumentList(QDBus::Block, QLatin1String("ServiceResolverNew"), argumentList);
     }
 
+    // HAND-EDIT: since Avahi 0.8, the resolver only emits signals once it is started
+    inline QDBusReply<QDBusObjectPath>
+    ServiceResolverPrepare(int interface, int protocol, const QString &name, const QString &type, const QString &domain, int aprotocol, uint flags)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(interface) << QVariant::fromValue(protocol) << QVariant::fromValue(name) << QVariant::fromValue(type)
+                     << QVariant::fromValue(domain) << QVariant::fromValue(aprotocol) << QVariant::fromValue(flags);
+        return callWithArgumentList(QDBus::Block, QLatin1String("ServiceResolverPrepare"), argumentList);
+    }
+
     inline QDBusReply<QDBusObjectPath> ServiceTypeBrowserNew(int interface, int protocol, const QString &domain, uint flags)
     {
         QList<QVariant> argumentList;
@@ -266,6 +357,14 @@ public Q_SLOTS: // METHODS
         return callWithArgumentList(QDBus::Block, QLatin1String("ServiceTypeBrowserNew"), argumentList);
     }
 
+    // HAND-EDIT: since Avahi 0.8, the browser only emits signals once it is started
+    inline QDBusReply<QDBusObjectPath> ServiceTypeBrowserPrepare(int interface, int protocol, const QString &domain, uint flags)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(interface) << QVariant::fromValue(protocol) << QVariant::fromValue(domain) << QVariant::fromValue(flags);
+        return callWithArgumentList(QDBus::Block, QLatin1String("ServiceTypeBrowserPrepare"), argumentList);
+    }
+
     inline QDBusReply<void> SetHostName(const QString &name)
     {
         QList<QVariant> argumentList;
@@ -279,6 +378,14 @@ Q_SIGNALS: // SIGNALS
 
 namespace KDNSSD
 {
+// HAND-EDIT: process wide proxy for the server object, use this instead of
+// creating a new one for every request
+OrgFreedesktopAvahiServerInterface *avahiServer();
+// HAND-EDIT: state and host name of the daemon, answered from memory. They
+// are only asked for once and then kept up to date from the StateChanged
+// signal of the server and from its owner changing.
+int avahiServerState();
+QString avahiHostName();
 void registerTypes();
 QString domainToDNS(const QString &domain);
 QString DNSToDomain(const QString &domain);
@@ -0,0 +1,128 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef BROWSEDSERVICES_P_H
+#define BROWSEDSERVICES_P_H
+
+#include "remoteservice.h"
+#include "servicebase_p.h"
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+#include <algorithm>
+#include <utility>
+
+namespace KDNSSD
+{
+// The services a ServiceBrowser knows, by key and by name, shared by the
+// backends. Entry is the backend's per-service data and needs a quint64
+// member `found`, which records when the service was found so that the
+// services can be listed in that order. Keeping the order that way costs
+// nothing when a service goes away.
+template<typename Entry>
+struct BrowsedServices {
+    using Iterator = typename QHash<ServiceKey, Entry>::iterator;
+    using ConstIterator = typename QHash<ServiceKey, Entry>::const_iterator;
+
+    QHash<ServiceKey, Entry> entries;
+    // service name to key, names are unique within a browsed type and domain
+    QHash<QString, ServiceKey> names;
+    quint64 nextFound = 0;
+
+    Entry &insert(const ServiceKey &key)
+    {
+        names.insert(key.name, key);
+        Entry &entry = entries[key];
+        entry.found = nextFound++;
+        return entry;
+    }
+
+    // returns the entry following it
+    Iterator erase(Iterator it)
+    {
+        names.remove(it.key().name);
+        return entries.erase(it);
+    }
+
+    void clear()
+    {
+        entries.clear();
+        names.clear();
+    }
+
+    // the entries in the order their services were found
+    QList<ConstIterator> inOrder() const
+    {
+        QList<ConstIterator> order;
+        order.reserve(entries.size());
+        for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+            order.append(it);
+        }
+        std::sort(order.begin(), order.end(), [](const ConstIterator &a, const ConstIterator &b) {
+            return a->found < b->found;
+        });
+        return order;
+    }
+};
+
+// The services reported since the last servicesAdded()/servicesRemoved(),
+// shared by the backends. A service that comes and goes within one batch
+// is left out of it, nobody has to hear about it.
+struct ServiceBatch {
+    QList<RemoteService::Ptr> added;
+    QList<RemoteService::Ptr> removed;
+    // the services of added that are still around
+    QSet<RemoteService *> pending;
+
+    void add(const RemoteService::Ptr &svr)
+    {
+        added.append(svr);
+        pending.insert(svr.data());
+    }
+
+    void remove(const RemoteService::Ptr &svr)
+    {
+        if (!pending.remove(svr.data())) {
+            removed.append(svr);
+        }
+    }
+
+    bool isEmpty() const
+    {
+        return added.isEmpty() && removed.isEmpty();
+    }
+
+    QList<RemoteService::Ptr> takeRemoved()
+    {
+        return std::exchange(removed, {});
+    }
+
+    // the added services that are still around, each of them once
+    QList<RemoteService::Ptr> takeAdded()
+    {
+        if (pending.size() != added.size()) {
+            added.removeIf([this](const RemoteService::Ptr &svr) {
+                return !pending.remove(svr.data());
+            });
+        }
+        pending.clear();
+        return std::exchange(added, {});
+    }
+
+    void clear()
+    {
+        added.clear();
+        removed.clear();
+        pending.clear();
+    }
+};
+
+}
+
+#endif
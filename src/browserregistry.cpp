@@ -0,0 +1,117 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "browserregistry_p.h"
+#include "kdnssd_debug.h"
+#include <QThreadStorage>
+
+#include <algorithm>
+#include <atomic>
+
+namespace KDNSSD
+{
+static QThreadStorage<BrowserRegistry *> s_registries;
+static std::atomic<int> s_cacheSize{8};
+
+BrowserRegistry::~BrowserRegistry()
+{
+    for (const auto &[key, browser] : std::as_const(m_idle)) {
+        delete browser;
+    }
+}
+
+BrowserRegistry *BrowserRegistry::self()
+{
+    if (!s_registries.hasLocalData()) {
+        s_registries.setLocalData(new BrowserRegistry);
+    }
+    return s_registries.localData();
+}
+
+QSharedPointer<ServiceBrowser> BrowserRegistry::acquire(const QString &type, bool autoResolve, const QString &domain, const QString &subtype)
+{
+    const Key key{type, domain, subtype, autoResolve};
+    if (QSharedPointer<ServiceBrowser> browser = m_active.value(key).toStrongRef()) {
+        return browser;
+    }
+
+    ServiceBrowser *browser = nullptr;
+    const auto idle = std::ranges::find(m_idle, key, &std::pair<Key, ServiceBrowser *>::first);
+    if (idle != m_idle.end()) {
+        browser = idle->second;
+        m_idle.erase(idle);
+        // what was found before is there already, only the changes follow
+        browser->resume();
+        qCDebug(KDNSSD_LOG) << "Reusing cached browser for" << type << domain << subtype;
+    } else {
+        // started by the consumer once it is connected
+        browser = new ServiceBrowser(type, autoResolve, domain, subtype);
+    }
+
+    QSharedPointer<ServiceBrowser> shared(browser, [key, registry = this](ServiceBrowser *browser) {
+        if (s_registries.hasLocalData() && s_registries.localData() == registry) {
+            registry->release(key, browser);
+        } else {
+            // dropped in another thread, or our thread is finishing
+            browser->deleteLater();
+        }
+    });
+    m_active.insert(key, shared);
+    return shared;
+}
+
+void BrowserRegistry::release(const Key &key, ServiceBrowser *browser)
+{
+    m_active.remove(key);
+    if (s_cacheSize == 0) {
+        // we may be called from within one of its signals
+        browser->deleteLater();
+        return;
+    }
+    browser->pause();
+    m_idle.append({key, browser});
+    trim();
+}
+
+void BrowserRegistry::trim()
+{
+    while (m_idle.size() > s_cacheSize) {
+        m_idle.takeFirst().second->deleteLater();
+    }
+}
+
+void BrowserRegistry::setCacheSize(int size)
+{
+    s_cacheSize = qMax(0, size);
+    // the registries of other threads follow on their next release
+    if (s_registries.hasLocalData()) {
+        s_registries.localData()->trim();
+    }
+}
+
+int BrowserRegistry::cacheSize()
+{
+    return s_cacheSize;
+}
+
+QSharedPointer<ServiceBrowser> ServiceBrowser::shared(const QString &type, bool autoResolve, const QString &domain, const QString &subtype)
+{
+    return BrowserRegistry::self()->acquire(type, autoResolve, domain, subtype);
+}
+
+void ServiceBrowser::setSharedCacheSize(int size)
+{
+    BrowserRegistry::setCacheSize(size);
+}
+
+int ServiceBrowser::sharedCacheSize()
+{
+    return BrowserRegistry::cacheSize();
+}
+
+}
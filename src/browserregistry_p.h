@@ -0,0 +1,67 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef BROWSERREGISTRY_P_H
+#define BROWSERREGISTRY_P_H
+
+#include "servicebrowser.h"
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QWeakPointer>
+
+#include <utility>
+
+namespace KDNSSD
+{
+// The browsers handed out by ServiceBrowser::shared(). Identical requests
+// share one browser. Once the last reference to it is dropped, the browser
+// is paused and kept for a while, so that a consumer coming back has the
+// result set right away and only the changes are browsed for.
+// There is one registry per thread, a browser is only shared with requests
+// from the thread it lives in.
+class BrowserRegistry
+{
+public:
+    ~BrowserRegistry();
+
+    // the registry of the current thread
+    static BrowserRegistry *self();
+
+    QSharedPointer<ServiceBrowser> acquire(const QString &type, bool autoResolve, const QString &domain, const QString &subtype);
+
+    // the cache size is the same for all threads
+    static void setCacheSize(int size);
+    static int cacheSize();
+
+private:
+    struct Key {
+        QString type;
+        QString domain;
+        QString subtype;
+        bool autoResolve;
+        bool operator==(const Key &) const = default;
+        friend size_t qHash(const Key &key, size_t seed)
+        {
+            return qHashMulti(seed, key.type, key.domain, key.subtype, key.autoResolve);
+        }
+    };
+
+    // the last reference to browser was dropped
+    void release(const Key &key, ServiceBrowser *browser);
+    // deletes the least recently released browsers beyond the cache size
+    void trim();
+
+    QHash<Key, QWeakPointer<ServiceBrowser>> m_active;
+    // released browsers, the most recently released one last
+    QList<std::pair<Key, ServiceBrowser *>> m_idle;
+};
+
+}
+
+#endif
@@ -81,9 +81,10 @@ public:
     /*!
      * Starts browsing.
      *
-     * \note Only the first call to this function will have any effect.
+     * \note This has no effect while browsing is running or paused.
      *
-     * Browsing stops when the DomainBrowser object is destroyed.
+     * Browsing stops when the DomainBrowser object is destroyed or
+     * stopBrowse() is called.
      *
      * \warning The domainAdded() signal may be emitted before this
      *          function returns.
@@ -92,10 +93,54 @@ public:
      */
     void startBrowse();
 
+    /*!
+     * Stops browsing.
+     *
+     * Everything held in the DNS-SD daemon on behalf of this browser is freed
+     * and the domains found so far are forgotten, domainRemoved() is not emitted
+     * for them. Browsing can be started again with startBrowse().
+     *
+     * \sa pause()
+     * \since 6.28
+     */
+    void stopBrowse();
+
+    /*!
+     * Suspends browsing, e.g. while the view showing the results is hidden.
+     *
+     * Like stopBrowse() this frees everything held in the DNS-SD daemon, so a
+     * paused browser puts no load on it. The domains found so far are kept
+     * though and can still be read from domains().
+     *
+     * \sa resume() and isPaused()
+     * \since 6.28
+     */
+    void pause();
+
+    /*!
+     * Continues browsing after pause().
+     *
+     * The domains known from before are not reported again, only the changes
+     * are: domainAdded() for those that appeared in the meantime and
+     * domainRemoved() for those that are not found again.
+     *
+     * \since 6.28
+     */
+    void resume();
+
+    /*!
+     * Whether browsing is paused.
+     *
+     * \sa pause()
+     * \since 6.28
+     */
+    bool isPaused() const;
+
     /*!
      * Whether the browsing has been started.
      *
-     * Returns \c true if startBrowse() has been called, \c false otherwise
+     * Returns \c true if startBrowse() has been called and browsing was not
+     * stopped since, \c false otherwise. A paused browser is still running.
      */
     bool isRunning() const;
 
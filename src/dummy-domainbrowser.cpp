@@ -29,6 +29,23 @@ void DomainBrowser::startBrowse()
 {
 }
 
+void DomainBrowser::stopBrowse()
+{
+}
+
+void DomainBrowser::pause()
+{
+}
+
+void DomainBrowser::resume()
+{
+}
+
+bool DomainBrowser::isPaused() const
+{
+    return false;
+}
+
 QStringList DomainBrowser::domains() const
 {
     return QStringList();
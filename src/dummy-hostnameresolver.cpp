@@ -0,0 +1,54 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "hostnameresolver.h"
+
+namespace KDNSSD
+{
+class HostNameResolverPrivate
+{
+public:
+    QString m_hostName;
+};
+
+HostNameResolver::HostNameResolver(const QString &hostName, QObject *parent)
+    : QObject(parent)
+    , d(new HostNameResolverPrivate{hostName})
+{
+}
+
+HostNameResolver::~HostNameResolver() = default;
+
+QString HostNameResolver::hostName() const
+{
+    Q_D(const HostNameResolver);
+    return d->m_hostName;
+}
+
+void HostNameResolver::resolveAsync()
+{
+    Q_EMIT resolved(false);
+}
+
+void HostNameResolver::cancel()
+{
+}
+
+bool HostNameResolver::isRunning() const
+{
+    return false;
+}
+
+QList<QHostAddress> HostNameResolver::addresses() const
+{
+    return QList<QHostAddress>();
+}
+
+}
+
+#include "moc_hostnameresolver.cpp"
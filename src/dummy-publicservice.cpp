@@ -37,7 +37,7 @@ void PublicService::setDomain(const QString &domain)
 
 void PublicService::setTextData(const QMap<QString, QByteArray> &textData)
 {
-    d->m_textData = textData;
+    d->m_textData = TxtRecord::fromMap(textData);
 }
 
 void PublicService::setType(const QString &type)
@@ -70,6 +70,11 @@ bool PublicService::publish()
     return false;
 }
 
+PublicService::WaitResult PublicService::publish(QDeadlineTimer)
+{
+    return Failed;
+}
+
 void PublicService::stop()
 {
 }
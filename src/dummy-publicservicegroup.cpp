@@ -0,0 +1,64 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "publicservice.h"
+#include "publicservicegroup.h"
+
+namespace KDNSSD
+{
+class PublicServiceGroupPrivate
+{
+public:
+    QList<PublicService *> m_services;
+};
+
+PublicServiceGroup::PublicServiceGroup(QObject *parent)
+    : QObject(parent)
+    , d(new PublicServiceGroupPrivate)
+{
+}
+
+PublicServiceGroup::~PublicServiceGroup() = default;
+
+void PublicServiceGroup::addService(PublicService *service)
+{
+    Q_D(PublicServiceGroup);
+    if (service && !d->m_services.contains(service)) {
+        d->m_services.append(service);
+    }
+}
+
+void PublicServiceGroup::removeService(PublicService *service)
+{
+    Q_D(PublicServiceGroup);
+    d->m_services.removeAll(service);
+}
+
+QList<PublicService *> PublicServiceGroup::services() const
+{
+    Q_D(const PublicServiceGroup);
+    return d->m_services;
+}
+
+void PublicServiceGroup::publishAsync()
+{
+    Q_EMIT published(false);
+}
+
+void PublicServiceGroup::stop()
+{
+}
+
+bool PublicServiceGroup::isPublished() const
+{
+    return false;
+}
+
+}
+
+#include "moc_publicservicegroup.cpp"
@@ -7,6 +7,7 @@
 */
 
 #include "remoteservice.h"
+#include "resolvescheduler_p.h"
 #include <QDataStream>
 
 namespace KDNSSD
@@ -25,6 +26,11 @@ bool RemoteService::resolve()
     return false;
 }
 
+RemoteService::WaitResult RemoteService::resolve(QDeadlineTimer)
+{
+    return Failed;
+}
+
 void RemoteService::resolveAsync()
 {
     Q_EMIT resolved(false);
@@ -35,6 +41,20 @@ bool RemoteService::isResolved() const
     return false;
 }
 
+void RemoteService::setResolveMode(ResolveMode)
+{
+    // dummy and empty
+}
+
+RemoteService::ResolveMode RemoteService::resolveMode() const
+{
+    return ResolveOnce;
+}
+
+void ResolveScheduler::stopResolve(RemoteService *)
+{
+}
+
 void RemoteService::virtual_hook(int, void *)
 {
     // BASE::virtual_hook(int, void*);
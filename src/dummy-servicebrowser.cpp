@@ -40,11 +40,47 @@ void ServiceBrowser::startBrowse()
     Q_EMIT finished();
 }
 
+void ServiceBrowser::stopBrowse()
+{
+}
+
+void ServiceBrowser::pause()
+{
+}
+
+void ServiceBrowser::resume()
+{
+}
+
+bool ServiceBrowser::isPaused() const
+{
+    return false;
+}
+
 QList<RemoteService::Ptr> ServiceBrowser::services() const
 {
     return QList<RemoteService::Ptr>();
 }
 
+RemoteService::Ptr ServiceBrowser::service(const QString &) const
+{
+    return RemoteService::Ptr();
+}
+
+QList<ServiceRecord> ServiceBrowser::records() const
+{
+    return QList<ServiceRecord>();
+}
+
+void ServiceBrowser::setRecordMode(bool)
+{
+}
+
+bool ServiceBrowser::isRecordMode() const
+{
+    return false;
+}
+
 void ServiceBrowser::virtual_hook(int, void *)
 {
 }
@@ -29,6 +29,23 @@ void ServiceTypeBrowser::startBrowse()
 {
 }
 
+void ServiceTypeBrowser::stopBrowse()
+{
+}
+
+void ServiceTypeBrowser::pause()
+{
+}
+
+void ServiceTypeBrowser::resume()
+{
+}
+
+bool ServiceTypeBrowser::isPaused() const
+{
+    return false;
+}
+
 QStringList ServiceTypeBrowser::serviceTypes() const
 {
     return QStringList();
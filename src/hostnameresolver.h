@@ -0,0 +1,118 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KDNSSDHOSTNAMERESOLVER_H
+#define KDNSSDHOSTNAMERESOLVER_H
+
+#include "kdnssd_export.h"
+#include <QHostAddress>
+#include <QList>
+#include <QObject>
+
+#include <memory>
+
+namespace KDNSSD
+{
+class HostNameResolverPrivate;
+
+/*!
+ * \class KDNSSD::HostNameResolver
+ * \inmodule KDNSSD
+ * \inheaderfile KDNSSD/HostNameResolver
+ *
+ * \brief Resolves an mDNS host name into its IP addresses asynchronously.
+ *
+ * Unlike ServiceBrowser::resolveHostName() this does not block and
+ * finds all addresses of the host, both IPv4 and IPv6. Every resolver
+ * works on its own, so an application can look up many hosts at the
+ * same time:
+ * \code
+ * for (const QString &host : hosts) {
+ *     auto resolver = new KDNSSD::HostNameResolver(host, this);
+ *     connect(resolver, &KDNSSD::HostNameResolver::resolved, this, [this, resolver](bool successful) {
+ *         if (successful) {
+ *             connectTo(resolver->addresses());
+ *         }
+ *         resolver->deleteLater();
+ *     });
+ *     resolver->resolveAsync();
+ * }
+ * \endcode
+ *
+ * \note A properly configured system is able to resolve mDNS host names
+ * through the system resolver as well, e.g. with QHostInfo.
+ *
+ * \since 6.28
+ */
+class KDNSSD_EXPORT HostNameResolver : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * Creates a resolver for \a hostName with the given \a parent.
+     *
+     * \a hostName is a host name in the link-local domain, such as
+     * \c mycomputer.local
+     */
+    explicit HostNameResolver(const QString &hostName, QObject *parent = nullptr);
+
+    /*!
+     * Cancels the lookup if it is still running.
+     */
+    ~HostNameResolver() override;
+
+    /*!
+     * Returns the host name this resolver looks up.
+     */
+    QString hostName() const;
+
+    /*!
+     * Starts looking up the addresses of the host.
+     *
+     * Returns immediately and emits resolved() when done. Does nothing if
+     * the lookup is already running.
+     *
+     * \note resolved() may be emitted before this method returns when an
+     * error is detected immediately.
+     */
+    void resolveAsync();
+
+    /*!
+     * Stops the lookup. resolved() is not emitted for it.
+     */
+    void cancel();
+
+    /*!
+     * Whether the lookup is running.
+     */
+    bool isRunning() const;
+
+    /*!
+     * Returns the addresses found by the last lookup, IPv4 and IPv6 alike.
+     */
+    QList<QHostAddress> addresses() const;
+
+Q_SIGNALS:
+    /*!
+     * Emitted when the lookup is complete.
+     *
+     * \a successful is \c true if at least one address was found, they
+     * can be read from addresses()
+     */
+    void resolved(bool successful);
+
+private:
+    friend class HostNameResolverPrivate;
+    std::unique_ptr<HostNameResolverPrivate> const d;
+    Q_DECLARE_PRIVATE_D(d, HostNameResolver)
+};
+
+}
+
+#endif
@@ -16,6 +16,11 @@
 #include <QHash>
 #include <QStringList>
 
+#include <utility>
+
+// domains may come from unicast DNS, give them as long as WAN services
+#define TIMEOUT_WAN 2000
+
 namespace KDNSSD
 {
 void domain_callback(DNSServiceRef, DNSServiceFlags flags, uint32_t, DNSServiceErrorType errorCode, const char *replyDomain, void *context);
@@ -24,6 +29,9 @@ DomainBrowser::DomainBrowser(DomainType type, QObject *parent)
     : QObject(parent)
     , d(new DomainBrowserPrivate(type, this))
 {
+    Q_D(DomainBrowser);
+    d->m_staleTimer.setSingleShot(true);
+    connect(&d->m_staleTimer, &QTimer::timeout, d, &DomainBrowserPrivate::removeStale);
 }
 
 DomainBrowser::~DomainBrowser() = default;
@@ -31,18 +39,60 @@ DomainBrowser::~DomainBrowser() = default;
 void DomainBrowser::startBrowse()
 {
     Q_D(DomainBrowser);
-    if (d->isRunning()) {
+    if (d->isRunning() || d->m_paused) {
         return;
     }
     DNSServiceRef ref;
+    const DNSServiceFlags share = Responder::shareConnection(ref);
     if (DNSServiceEnumerateDomains(&ref,
-                                   (d->m_type == Browsing) ? kDNSServiceFlagsBrowseDomains : kDNSServiceFlagsBrowseDomains,
+                                   share | ((d->m_type == Browsing) ? kDNSServiceFlagsBrowseDomains : kDNSServiceFlagsBrowseDomains),
                                    0,
                                    domain_callback,
                                    reinterpret_cast<void *>(d))
         == kDNSServiceErr_NoError) {
-        d->setRef(ref);
+        d->setRef(ref, share);
+    }
+}
+
+void DomainBrowser::stopBrowse()
+{
+    Q_D(DomainBrowser);
+    d->stop();
+    d->m_staleTimer.stop();
+    d->m_domains.clear();
+    d->m_stale.clear();
+    d->m_paused = false;
+}
+
+void DomainBrowser::pause()
+{
+    Q_D(DomainBrowser);
+    if (!d->isRunning()) {
+        return;
     }
+    d->stop();
+    d->m_staleTimer.stop();
+    d->m_paused = true;
+}
+
+void DomainBrowser::resume()
+{
+    Q_D(DomainBrowser);
+    if (!d->m_paused) {
+        return;
+    }
+    d->m_paused = false;
+    // keep the domains and only report those that are not found again
+    d->m_stale += std::exchange(d->m_domains, {});
+    startBrowse();
+    // the first answer of the daemon need not hold all it knows
+    d->m_staleTimer.start(TIMEOUT_WAN);
+}
+
+bool DomainBrowser::isPaused() const
+{
+    Q_D(const DomainBrowser);
+    return d->m_paused;
 }
 
 void DomainBrowserPrivate::customEvent(QEvent *event)
@@ -54,28 +104,39 @@ void DomainBrowserPrivate::customEvent(QEvent *event)
         AddRemoveEvent *aev = static_cast<AddRemoveEvent *>(event);
         if (aev->m_op == AddRemoveEvent::Add) {
             // FIXME: check if domain name is not name+domain (there was some mdnsd weirdness)
-            if (m_domains.contains(aev->m_domain)) {
-                return;
+            if (!m_domains.contains(aev->m_domain)) {
+                m_domains.append(aev->m_domain);
+                // known from before the pause already
+                if (!m_stale.removeOne(aev->m_domain)) {
+                    Q_EMIT m_parent->domainAdded(aev->m_domain);
+                }
             }
-            m_domains.append(aev->m_domain);
-            Q_EMIT m_parent->domainAdded(aev->m_domain);
         } else {
             m_domains.removeAll(aev->m_domain);
+            m_stale.removeAll(aev->m_domain);
             Q_EMIT m_parent->domainRemoved(aev->m_domain);
         }
     }
 }
 
+void DomainBrowserPrivate::removeStale()
+{
+    const QStringList gone = std::exchange(m_stale, {});
+    for (const QString &domain : gone) {
+        Q_EMIT m_parent->domainRemoved(domain);
+    }
+}
+
 QStringList DomainBrowser::domains() const
 {
     Q_D(const DomainBrowser);
-    return d->m_domains;
+    return d->m_domains + d->m_stale;
 }
 
 bool DomainBrowser::isRunning() const
 {
     Q_D(const DomainBrowser);
-    return d->isRunning();
+    return d->isRunning() || d->m_paused;
 }
 
 void domain_callback(DNSServiceRef, DNSServiceFlags flags, uint32_t, DNSServiceErrorType errorCode, const char *replyDomain, void *context)
@@ -12,6 +12,7 @@
 #include "domainbrowser.h"
 #include "mdnsd-responder.h"
 #include <QStringList>
+#include <QTimer>
 
 namespace KDNSSD
 {
@@ -28,6 +29,12 @@ public:
     DomainBrowser::DomainType m_type;
     DomainBrowser *m_parent = nullptr;
     QStringList m_domains;
+    // domains reported before browsing was paused that have not been found
+    // again yet, removed once the browse times out
+    QStringList m_stale;
+    QTimer m_staleTimer;
+    bool m_paused = false;
+    void removeStale();
     virtual void customEvent(QEvent *event);
 };
 
@@ -0,0 +1,168 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "hostnameresolver.h"
+#include "mdnsd-responder.h"
+#include "mdnsd-sdevent.h"
+#include <QCoreApplication>
+#include <QTimer>
+
+// time allowed for the other address family once the first answers are in
+#define SETTLE_TIMEOUT 200
+// hosts that do not answer at all
+#define LOOKUP_TIMEOUT 5000
+
+namespace KDNSSD
+{
+void addrinfo_callback(DNSServiceRef,
+                       DNSServiceFlags flags,
+                       uint32_t,
+                       DNSServiceErrorType errorCode,
+                       const char *,
+                       const struct sockaddr *address,
+                       uint32_t,
+                       void *context);
+
+class HostNameResolverPrivate : public Responder
+{
+public:
+    HostNameResolverPrivate(HostNameResolver *parent, const QString &hostName)
+        : Responder()
+        , m_parent(parent)
+        , m_hostName(hostName)
+    {
+        m_settle.setSingleShot(true);
+        m_timeout.setSingleShot(true);
+        connect(&m_settle, &QTimer::timeout, this, &HostNameResolverPrivate::finish);
+        connect(&m_timeout, &QTimer::timeout, this, &HostNameResolverPrivate::finish);
+    }
+
+    HostNameResolver *m_parent;
+    QString m_hostName;
+    QList<QHostAddress> m_addresses;
+    // DNSServiceGetAddrInfo() keeps watching the host and never says it is
+    // done, so the lookup ends by time.
+    QTimer m_settle;
+    QTimer m_timeout;
+
+    void finish();
+    void customEvent(QEvent *event) override;
+};
+
+void HostNameResolverPrivate::finish()
+{
+    m_settle.stop();
+    m_timeout.stop();
+    stop();
+    Q_EMIT m_parent->resolved(!m_addresses.isEmpty());
+}
+
+void HostNameResolverPrivate::customEvent(QEvent *event)
+{
+    if (event->type() == QEvent::User + SD_ERROR) {
+        finish();
+    }
+    if (event->type() == QEvent::User + SD_ADDRESS) {
+        AddressEvent *aev = static_cast<AddressEvent *>(event);
+        if (aev->m_op == AddressEvent::Add) {
+            if (!m_addresses.contains(aev->m_address)) {
+                m_addresses.append(aev->m_address);
+            }
+        } else {
+            m_addresses.removeAll(aev->m_address);
+        }
+        if (aev->m_last && !m_settle.isActive()) {
+            m_settle.start(SETTLE_TIMEOUT);
+        }
+    }
+}
+
+HostNameResolver::HostNameResolver(const QString &hostName, QObject *parent)
+    : QObject(parent)
+    , d(new HostNameResolverPrivate(this, hostName))
+{
+}
+
+HostNameResolver::~HostNameResolver() = default;
+
+QString HostNameResolver::hostName() const
+{
+    Q_D(const HostNameResolver);
+    return d->m_hostName;
+}
+
+void HostNameResolver::resolveAsync()
+{
+    Q_D(HostNameResolver);
+    if (d->isRunning()) {
+        return;
+    }
+    d->m_addresses.clear();
+    DNSServiceRef ref;
+    const DNSServiceFlags share = Responder::shareConnection(ref);
+    if (DNSServiceGetAddrInfo(&ref,
+                              share,
+                              0,
+                              kDNSServiceProtocol_IPv4 | kDNSServiceProtocol_IPv6,
+                              domainToDNS(d->m_hostName).constData(),
+                              addrinfo_callback,
+                              reinterpret_cast<void *>(d))
+        == kDNSServiceErr_NoError) {
+        d->setRef(ref, share);
+    }
+    if (!d->isRunning()) {
+        Q_EMIT resolved(false);
+    } else {
+        d->m_timeout.start(LOOKUP_TIMEOUT);
+    }
+}
+
+void HostNameResolver::cancel()
+{
+    Q_D(HostNameResolver);
+    d->m_settle.stop();
+    d->m_timeout.stop();
+    d->stop();
+}
+
+bool HostNameResolver::isRunning() const
+{
+    Q_D(const HostNameResolver);
+    return d->isRunning();
+}
+
+QList<QHostAddress> HostNameResolver::addresses() const
+{
+    Q_D(const HostNameResolver);
+    return d->m_addresses;
+}
+
+void addrinfo_callback(DNSServiceRef,
+                       DNSServiceFlags flags,
+                       uint32_t,
+                       DNSServiceErrorType errorCode,
+                       const char *,
+                       const struct sockaddr *address,
+                       uint32_t,
+                       void *context)
+{
+    QObject *obj = reinterpret_cast<QObject *>(context);
+    if (errorCode != kDNSServiceErr_NoError) {
+        ErrorEvent err;
+        QCoreApplication::sendEvent(obj, &err);
+    } else {
+        AddressEvent aev((flags & kDNSServiceFlagsAdd) ? AddressEvent::Add : AddressEvent::Remove,
+                         QHostAddress(address),
+                         !(flags & kDNSServiceFlagsMoreComing));
+        QCoreApplication::sendEvent(obj, &aev);
+    }
+}
+
+}
+
+#include "moc_hostnameresolver.cpp"
@@ -10,8 +10,11 @@
 #include "mdnsd-sdevent.h"
 #include "publicservice.h"
 #include "servicebase_p.h"
+#include "syncwaiter_p.h"
 #include <QCoreApplication>
 #include <QStringList>
+#include <QTimer>
+#include <utility>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -37,9 +40,81 @@ public:
     bool m_published;
     PublicService *m_parent;
     QStringList m_subtypes;
+    // Changes made by the setters are applied once control returns to the
+    // event loop, so that a batch of them costs a single registration.
+    enum Update {
+        NoUpdate,
+        TextUpdate,
+        FullUpdate,
+    };
+    Update m_pendingUpdate = NoUpdate;
+    QTimer m_updateTimer;
+    // set while publish() blocks, stop() ends the wait
+    SyncWaiter *m_waiter = nullptr;
+    // false if the TXT data has entries that mDNSResponder does not accept
+    bool m_validTextData = true;
+    void scheduleUpdate(Update update);
+    void applyUpdate();
+    // Replaces the TXT record of the registered service in place.
+    bool updateTextData();
     virtual void customEvent(QEvent *event);
 };
 
+// the checks TXTRecordSetValue() does: keys are printable ASCII without '=',
+// and key and value have to fit into one TXT string
+static bool isValidTextData(const QMap<QString, QByteArray> &textData)
+{
+    for (auto it = textData.cbegin(); it != textData.cend(); ++it) {
+        const QString &key = it.key();
+        for (const QChar c : key) {
+            if (c.unicode() < 0x20 || c.unicode() > 0x7e || c == QLatin1Char('=')) {
+                return false;
+            }
+        }
+        if (key.size() + (it.value().isNull() ? 0 : 1 + it.value().size()) > 255) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PublicServicePrivate::scheduleUpdate(Update update)
+{
+    if (!isRunning()) {
+        return;
+    }
+    m_pendingUpdate = qMax(m_pendingUpdate, update);
+    m_updateTimer.start();
+}
+
+void PublicServicePrivate::applyUpdate()
+{
+    switch (std::exchange(m_pendingUpdate, NoUpdate)) {
+    case TextUpdate:
+        // no need to withdraw and probe the service again just for its TXT record
+        if (updateTextData()) {
+            break;
+        }
+        [[fallthrough]];
+    case FullUpdate:
+        // registers the service again with the current data
+        m_parent->publishAsync();
+        break;
+    case NoUpdate:
+        break;
+    }
+}
+
+bool PublicServicePrivate::updateTextData()
+{
+    if (!m_validTextData) {
+        return false;
+    }
+    const QByteArray &txt = m_textData.wire();
+    // a null record reference means the primary TXT record of the service
+    return DNSServiceUpdateRecord(m_ref, nullptr, 0, txt.size(), txt.constData(), 0) == kDNSServiceErr_NoError;
+}
+
 PublicService::PublicService(const QString &name, const QString &type, unsigned int port, const QString &domain, const QStringList &subtypes)
     : QObject()
     , ServiceBase(new PublicServicePrivate(this, name, type, port, domain))
@@ -49,6 +124,9 @@ PublicService::PublicService(const QString &name, const QString &type, unsigned
         d->m_domain = "local.";
     }
     d->m_subtypes = subtypes;
+    d->m_updateTimer.setSingleShot(true);
+    d->m_updateTimer.setInterval(0);
+    connect(&d->m_updateTimer, &QTimer::timeout, d, &PublicServicePrivate::applyUpdate);
 }
 
 PublicService::~PublicService()
@@ -60,20 +138,14 @@ void PublicService::setServiceName(const QString &serviceName)
 {
     KDNSSD_D;
     d->m_serviceName = serviceName;
-    if (d->isRunning()) {
-        stop();
-        publishAsync();
-    }
+    d->scheduleUpdate(PublicServicePrivate::FullUpdate);
 }
 
 void PublicService::setDomain(const QString &domain)
 {
     KDNSSD_D;
     d->m_domain = domain;
-    if (d->isRunning()) {
-        stop();
-        publishAsync();
-    }
+    d->scheduleUpdate(PublicServicePrivate::FullUpdate);
 }
 
 QStringList PublicService::subtypes() const
@@ -86,30 +158,21 @@ void PublicService::setType(const QString &type)
 {
     KDNSSD_D;
     d->m_type = type;
-    if (d->isRunning()) {
-        stop();
-        publishAsync();
-    }
+    d->scheduleUpdate(PublicServicePrivate::FullUpdate);
 }
 
 void PublicService::setSubTypes(const QStringList &subtypes)
 {
     KDNSSD_D;
     d->m_subtypes = subtypes;
-    if (d->isRunning()) {
-        stop();
-        publishAsync();
-    }
+    d->scheduleUpdate(PublicServicePrivate::FullUpdate);
 }
 
 void PublicService::setPort(unsigned short port)
 {
     KDNSSD_D;
     d->m_port = port;
-    if (d->isRunning()) {
-        stop();
-        publishAsync();
-    }
+    d->scheduleUpdate(PublicServicePrivate::FullUpdate);
 }
 
 bool PublicService::isPublished() const
@@ -121,28 +184,42 @@ bool PublicService::isPublished() const
 void PublicService::setTextData(const QMap<QString, QByteArray> &textData)
 {
     KDNSSD_D;
-    d->m_textData = textData;
-    if (d->isRunning()) {
-        stop();
-        publishAsync();
-    }
+    d->m_textData = TxtRecord::fromMap(textData);
+    d->m_validTextData = isValidTextData(textData);
+    d->scheduleUpdate(PublicServicePrivate::TextUpdate);
 }
 
 bool PublicService::publish()
+{
+    return publish(QDeadlineTimer(QDeadlineTimer::Forever)) == Succeeded;
+}
+
+PublicService::WaitResult PublicService::publish(QDeadlineTimer deadline)
 {
     KDNSSD_D;
+    SyncWaiter waiter(this, &PublicService::published);
+    // the replies are read by the socket notifier of the registration
     publishAsync();
-    while (d->isRunning() && !d->m_published) {
-        d->process();
+    // not any earlier, publishAsync() stops a running registration first
+    d->m_waiter = &waiter;
+    const WaitResult result = waiter.wait(deadline);
+    d->m_waiter = nullptr;
+    if (result == TimedOut) {
+        stop();
     }
-    return d->m_published;
+    return result;
 }
 
 void PublicService::stop()
 {
     KDNSSD_D;
     d->stop();
+    d->m_updateTimer.stop();
+    d->m_pendingUpdate = PublicServicePrivate::NoUpdate;
     d->m_published = false;
+    if (d->m_waiter) {
+        d->m_waiter->finish(false);
+    }
 }
 
 void PublicService::publishAsync()
@@ -151,37 +228,32 @@ void PublicService::publishAsync()
     if (d->isRunning()) {
         stop();
     }
-    TXTRecordRef txt;
-    TXTRecordCreate(&txt, 0, 0);
-    QMap<QString, QByteArray>::ConstIterator itEnd = d->m_textData.cend();
-    for (QMap<QString, QByteArray>::ConstIterator it = d->m_textData.cbegin(); it != itEnd; ++it) {
-        if (TXTRecordSetValue(&txt, it.key().toUtf8().constData(), it.value().length(), it.value().constData()) != kDNSServiceErr_NoError) {
-            TXTRecordDeallocate(&txt);
-            Q_EMIT published(false);
-            return;
-        }
+    if (!d->m_validTextData) {
+        Q_EMIT published(false);
+        return;
     }
+    const QByteArray &txt = d->m_textData.wire();
     DNSServiceRef ref;
+    const DNSServiceFlags share = Responder::shareConnection(ref);
     QString fullType = d->m_type;
     for (const QString &subtype : std::as_const(d->m_subtypes)) {
         fullType += ',' + subtype;
     }
     if (DNSServiceRegister(&ref,
-                           0,
+                           share,
                            0,
                            d->m_serviceName.toUtf8().constData(),
                            fullType.toLatin1().constData(),
                            domainToDNS(d->m_domain).constData(),
                            NULL,
                            htons(d->m_port),
-                           TXTRecordGetLength(&txt),
-                           TXTRecordGetBytesPtr(&txt),
+                           txt.size(),
+                           txt.constData(),
                            publish_callback,
                            reinterpret_cast<void *>(d))
         == kDNSServiceErr_NoError) {
-        d->setRef(ref);
+        d->setRef(ref, share);
     }
-    TXTRecordDeallocate(&txt);
     if (!d->isRunning()) {
         Q_EMIT published(false);
     }
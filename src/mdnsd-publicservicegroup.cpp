@@ -0,0 +1,151 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "publicservice.h"
+#include "publicservicegroup.h"
+#include <QPointer>
+#include <QSet>
+
+namespace KDNSSD
+{
+// mDNSResponder has no notion of a group of records committed together,
+// every service is registered on its own and the group only collects the
+// results. Collisions are already handled per service by the daemon.
+class PublicServiceGroupPrivate
+{
+public:
+    PublicServiceGroupPrivate(PublicServiceGroup *parent)
+        : m_parent(parent)
+    {
+    }
+
+    void memberPublished(PublicService *service, bool success);
+
+    PublicServiceGroup *m_parent;
+    QList<QPointer<PublicService>> m_services;
+    // members that have not reported to be published yet
+    QSet<PublicService *> m_waiting;
+    bool m_running = false;
+    bool m_published = false;
+};
+
+void PublicServiceGroupPrivate::memberPublished(PublicService *service, bool success)
+{
+    if (!m_running) {
+        return;
+    }
+    if (!success) {
+        m_parent->stop();
+        Q_EMIT m_parent->published(false);
+        return;
+    }
+    m_waiting.remove(service);
+    if (m_waiting.isEmpty() && !m_published) {
+        m_published = true;
+        Q_EMIT m_parent->published(true);
+    }
+}
+
+PublicServiceGroup::PublicServiceGroup(QObject *parent)
+    : QObject(parent)
+    , d(new PublicServiceGroupPrivate(this))
+{
+}
+
+PublicServiceGroup::~PublicServiceGroup()
+{
+    stop();
+}
+
+void PublicServiceGroup::addService(PublicService *service)
+{
+    Q_D(PublicServiceGroup);
+    if (!service || d->m_services.contains(service)) {
+        return;
+    }
+    d->m_services.append(service);
+    connect(service, &PublicService::published, this, [d, service](bool success) {
+        d->memberPublished(service, success);
+    });
+    connect(service, &QObject::destroyed, this, [d, service]() {
+        d->m_services.removeAll(nullptr);
+        d->memberPublished(service, true);
+    });
+    if (d->m_running) {
+        d->m_waiting.insert(service);
+        d->m_published = false;
+        service->publishAsync();
+    }
+}
+
+void PublicServiceGroup::removeService(PublicService *service)
+{
+    Q_D(PublicServiceGroup);
+    if (!d->m_services.removeAll(service)) {
+        return;
+    }
+    disconnect(service, nullptr, this, nullptr);
+    service->stop();
+    d->memberPublished(service, true);
+}
+
+QList<PublicService *> PublicServiceGroup::services() const
+{
+    Q_D(const PublicServiceGroup);
+    QList<PublicService *> services;
+    services.reserve(d->m_services.size());
+    for (const QPointer<PublicService> &service : d->m_services) {
+        if (service) {
+            services.append(service);
+        }
+    }
+    return services;
+}
+
+void PublicServiceGroup::publishAsync()
+{
+    Q_D(PublicServiceGroup);
+    if (d->m_running) {
+        stop();
+    }
+    d->m_running = true;
+    d->m_services.removeAll(nullptr);
+    const QList<PublicService *> members = services();
+    d->m_waiting = QSet<PublicService *>(members.cbegin(), members.cend());
+    if (members.isEmpty()) {
+        d->m_published = true;
+        Q_EMIT published(true);
+        return;
+    }
+    for (PublicService *service : members) {
+        service->publishAsync();
+    }
+}
+
+void PublicServiceGroup::stop()
+{
+    Q_D(PublicServiceGroup);
+    d->m_running = false;
+    d->m_published = false;
+    d->m_waiting.clear();
+    for (const QPointer<PublicService> &service : std::as_const(d->m_services)) {
+        if (service) {
+            service->stop();
+        }
+    }
+}
+
+bool PublicServiceGroup::isPublished() const
+{
+    Q_D(const PublicServiceGroup);
+    return d->m_published;
+}
+
+}
+
+#include "moc_publicservicegroup.cpp"
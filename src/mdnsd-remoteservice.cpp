@@ -9,7 +9,10 @@
 #include "mdnsd-responder.h"
 #include "mdnsd-sdevent.h"
 #include "remoteservice.h"
+#include "resolvescheduler_p.h"
 #include "servicebase_p.h"
+#include "servicecache_p.h"
+#include "syncwaiter_p.h"
 #include <QCoreApplication>
 #include <QDebug>
 #include <QEventLoop>
@@ -46,6 +49,7 @@ public:
     {
     }
     bool m_resolved;
+    RemoteService::ResolveMode m_resolveMode = RemoteService::ResolveOnce;
     RemoteService *m_parent;
     virtual void customEvent(QEvent *event);
 };
@@ -53,6 +57,8 @@ public:
 RemoteService::RemoteService(const QString &name, const QString &type, const QString &domain)
     : ServiceBase(new RemoteServicePrivate(this, name, type, domain))
 {
+    KDNSSD_D;
+    d->m_resolved = ServiceCache::self()->lookup(d);
 }
 
 RemoteService::~RemoteService()
@@ -60,14 +66,19 @@ RemoteService::~RemoteService()
 }
 
 bool RemoteService::resolve()
+{
+    return resolve(QDeadlineTimer(QDeadlineTimer::Forever)) == Succeeded;
+}
+
+RemoteService::WaitResult RemoteService::resolve(QDeadlineTimer deadline)
 {
     KDNSSD_D;
+    SyncWaiter waiter(this, &RemoteService::resolved);
     resolveAsync();
-    while (d->isRunning() && !d->m_resolved) {
-        d->process();
-    }
+    // the replies are read by the socket notifier of the request
+    const WaitResult result = waiter.wait(deadline);
     d->stop();
-    return d->m_resolved;
+    return result;
 }
 
 void RemoteService::resolveAsync()
@@ -77,10 +88,16 @@ void RemoteService::resolveAsync()
         return;
     }
     d->m_resolved = false;
+    if (d->m_resolveMode == ResolveOnce && ServiceCache::self()->lookupForResolve(d)) {
+        d->m_resolved = true;
+        Q_EMIT resolved(true);
+        return;
+    }
     // qDebug() << this << ":Starting resolve of : " << d->m_serviceName << " " << d->m_type << " " << d->m_domain << "\n";
     DNSServiceRef ref;
+    const DNSServiceFlags share = Responder::shareConnection(ref);
     if (DNSServiceResolve(&ref,
-                          0,
+                          share,
                           0,
                           d->m_serviceName.toUtf8().constData(),
                           d->m_type.toLatin1().constData(),
@@ -88,7 +105,7 @@ void RemoteService::resolveAsync()
                           (DNSServiceResolveReply)resolve_callback,
                           reinterpret_cast<void *>(d))
         == kDNSServiceErr_NoError) {
-        d->setRef(ref);
+        d->setRef(ref, share);
     }
     if (!d->isRunning()) {
         Q_EMIT resolved(false);
@@ -101,9 +118,22 @@ bool RemoteService::isResolved() const
     return d->m_resolved;
 }
 
+void RemoteService::setResolveMode(ResolveMode mode)
+{
+    KDNSSD_D;
+    d->m_resolveMode = mode;
+}
+
+RemoteService::ResolveMode RemoteService::resolveMode() const
+{
+    KDNSSD_D;
+    return d->m_resolveMode;
+}
+
 void RemoteServicePrivate::customEvent(QEvent *event)
 {
     if (event->type() == QEvent::User + SD_ERROR) {
+        ServiceCache::self()->remove(m_serviceName, m_type, m_domain);
         stop();
         m_resolved = false;
         Q_EMIT m_parent->resolved(false);
@@ -114,10 +144,19 @@ void RemoteServicePrivate::customEvent(QEvent *event)
         m_port = rev->m_port;
         m_textData = rev->m_txtdata;
         m_resolved = true;
+        ServiceCache::self()->insert(m_serviceName, m_type, m_domain, this);
+        if (m_resolveMode == RemoteService::ResolveOnce) {
+            stop();
+        }
         Q_EMIT m_parent->resolved(true);
     }
 }
 
+void ResolveScheduler::stopResolve(RemoteService *svr)
+{
+    static_cast<RemoteServicePrivate *>(svr->d.operator->())->stop();
+}
+
 void RemoteService::virtual_hook(int, void *)
 {
     // BASE::virtual_hook(int, void*);
@@ -140,20 +179,8 @@ void resolve_callback(DNSServiceRef,
         QCoreApplication::sendEvent(obj, &err);
         return;
     }
-    char key[256];
-    int index = 0;
-    unsigned char valueLen;
     // qDebug() << "Resolve callback\n";
-    QMap<QString, QByteArray> map;
-    const void *voidValue = 0;
-    while (TXTRecordGetItemAtIndex(txtLen, txtRecord, index++, 256, key, &valueLen, &voidValue) == kDNSServiceErr_NoError) {
-        if (voidValue) {
-            map[QString::fromUtf8(key)] = QByteArray((const char *)voidValue, valueLen);
-        } else {
-            map[QString::fromUtf8(key)].clear();
-        }
-    }
-    ResolveEvent rev(DNSToDomain(hosttarget), ntohs(port), map);
+    ResolveEvent rev(DNSToDomain(hosttarget), ntohs(port), TxtRecord::fromWire(QByteArray(reinterpret_cast<const char *>(txtRecord), txtLen)));
     QCoreApplication::sendEvent(obj, &rev);
 }
 
@@ -7,23 +7,31 @@
 */
 
 #include "mdnsd-responder.h"
+#include "kdnssd_debug.h"
+#include "mdnsd-sdevent.h"
 #include "servicebase.h"
 #include <QCoreApplication>
+#include <QPointer>
+#include <QThreadStorage>
 #include <QUrl>
+#include <utility>
 
 namespace KDNSSD
 {
+static QThreadStorage<SharedConnection *> s_connections;
+QAtomicInt SharedConnection::s_sockets;
+
 Responder::Responder(DNSServiceRef ref, QObject *parent)
     : QObject(parent)
     , m_ref(0)
-    , m_socket(0)
+    , m_running(false)
 {
-    setRef(ref);
+    setRef(ref, 0);
 }
 
-void Responder::setRef(DNSServiceRef ref)
+void Responder::setRef(DNSServiceRef ref, DNSServiceFlags share)
 {
-    if (m_socket || m_ref) {
+    if (m_ref) {
         stop();
     }
     m_running = false;
@@ -31,12 +39,18 @@ void Responder::setRef(DNSServiceRef ref)
     if (m_ref == 0) {
         return;
     }
-    int fd = DNSServiceRefSockFD(ref);
-    if (fd == -1) {
-        return;
+    if (share & kDNSServiceFlagsShareConnection) {
+        m_connection = SharedConnection::self();
+        m_connection->addResponder(this);
+    } else {
+        const int fd = DNSServiceRefSockFD(m_ref);
+        if (fd == -1) {
+            return;
+        }
+        m_socket = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(m_socket, &QSocketNotifier::activated, this, &Responder::process);
+        s_sockets.fetchAndAddRelaxed(1);
     }
-    m_socket = new QSocketNotifier(fd, QSocketNotifier::Read, this);
-    connect(m_socket, SIGNAL(activated(int)), this, SLOT(process()));
     m_running = true;
 }
 Responder::~Responder()
@@ -46,8 +60,16 @@ Responder::~Responder()
 
 void Responder::stop()
 {
-    delete m_socket;
-    m_socket = 0;
+    if (m_connection) {
+        m_connection->removeResponder(this);
+        m_connection = nullptr;
+    }
+    if (m_socket) {
+        delete m_socket;
+        m_socket = nullptr;
+        s_sockets.fetchAndSubRelaxed(1);
+    }
+    // a shared connection stays open, only this operation ends
     if (m_ref) {
         DNSServiceRefDeallocate(m_ref);
     }
@@ -55,6 +77,22 @@ void Responder::stop()
     m_running = false;
 }
 
+void Responder::connectionLost(bool report)
+{
+    m_connection = nullptr;
+    m_ref = 0;
+    m_running = false;
+    if (report) {
+        ErrorEvent err;
+        QCoreApplication::sendEvent(this, &err);
+    }
+}
+
+bool Responder::isRunning() const
+{
+    return m_running;
+}
+
 void Responder::process()
 {
     if (DNSServiceProcessResult(m_ref) != kDNSServiceErr_NoError) {
@@ -62,9 +100,113 @@ void Responder::process()
     }
 }
 
-bool Responder::isRunning() const
+DNSServiceFlags Responder::shareConnection(DNSServiceRef &ref)
 {
-    return m_running;
+    ref = SharedConnection::self()->ref();
+    return ref ? kDNSServiceFlagsShareConnection : 0;
+}
+
+bool Responder::isAvailable()
+{
+    // Connecting is needed for anything else anyway, the connection is
+    // kept. Without shared connections there is nothing to try ahead.
+    SharedConnection *connection = SharedConnection::self();
+    return connection->ref() || !connection->isSupported();
+}
+
+SharedConnection::~SharedConnection()
+{
+    close(false);
+}
+
+SharedConnection *SharedConnection::self()
+{
+    if (!s_connections.hasLocalData()) {
+        s_connections.setLocalData(new SharedConnection);
+    }
+    return s_connections.localData();
+}
+
+int SharedConnection::socketCount()
+{
+    return s_sockets.loadRelaxed();
+}
+
+DNSServiceRef SharedConnection::ref()
+{
+    if (m_ref || m_unsupported) {
+        return m_ref;
+    }
+    const DNSServiceErrorType error = DNSServiceCreateConnection(&m_ref);
+    if (error != kDNSServiceErr_NoError) {
+        m_ref = nullptr;
+        if (error == kDNSServiceErr_Unsupported) {
+            qCDebug(KDNSSD_LOG) << "Shared connections to mdnsd are not supported, every operation connects on its own";
+            m_unsupported = true;
+        }
+        return nullptr;
+    }
+    const int fd = DNSServiceRefSockFD(m_ref);
+    if (fd == -1) {
+        DNSServiceRefDeallocate(m_ref);
+        m_ref = nullptr;
+        return nullptr;
+    }
+    m_socket = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(m_socket, &QSocketNotifier::activated, this, &SharedConnection::process);
+    qCDebug(KDNSSD_LOG) << "Connected to mdnsd," << s_sockets.fetchAndAddRelaxed(1) + 1 << "sockets open";
+    return m_ref;
+}
+
+bool SharedConnection::isSupported() const
+{
+    return !m_unsupported;
+}
+
+void SharedConnection::addResponder(Responder *responder)
+{
+    m_responders.insert(responder);
+}
+
+void SharedConnection::removeResponder(Responder *responder)
+{
+    m_responders.remove(responder);
+}
+
+void SharedConnection::process()
+{
+    // runs the callbacks of all operations that have something to report
+    if (DNSServiceProcessResult(m_ref) != kDNSServiceErr_NoError) {
+        qCWarning(KDNSSD_LOG) << "Lost connection to mdnsd, stopping" << m_responders.size() << "operations";
+        close(true);
+    }
+}
+
+void SharedConnection::close(bool report)
+{
+    if (!m_ref) {
+        return;
+    }
+    delete m_socket;
+    m_socket = nullptr;
+    DNSServiceRefDeallocate(m_ref);
+    m_ref = nullptr;
+    s_sockets.fetchAndSubRelaxed(1);
+
+    // The operations are gone with the connection, their refs must not be
+    // deallocated again. A responder may start over from its error handling,
+    // which connects anew.
+    QList<QPointer<Responder>> responders;
+    responders.reserve(m_responders.size());
+    for (Responder *responder : std::as_const(m_responders)) {
+        responders.append(responder);
+    }
+    m_responders.clear();
+    for (const QPointer<Responder> &responder : std::as_const(responders)) {
+        if (responder) {
+            responder->connectionLost(report);
+        }
+    }
 }
 
 QByteArray domainToDNS(const QString &domain)
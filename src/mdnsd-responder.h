@@ -9,12 +9,16 @@
 #ifndef MDNSD_RESPONDER_H
 #define MDNSD_RESPONDER_H
 
+#include <QAtomicInt>
 #include <QObject>
+#include <QSet>
 #include <QSocketNotifier>
 #include <dns_sd.h>
 
 namespace KDNSSD
 {
+class SharedConnection;
+
 class Responder : public QObject
 {
     Q_OBJECT
@@ -29,15 +33,82 @@ public:
     It needs mDNSResponder running.
      */
     bool isRunning() const;
-    void setRef(DNSServiceRef ref);
+    // ref is an operation started with the flags returned by
+    // shareConnection(), share are those flags
+    void setRef(DNSServiceRef ref, DNSServiceFlags share);
     void stop();
-public Q_SLOTS:
-    void process();
+
+    // Prepares ref for a new operation. Returns
+    // kDNSServiceFlagsShareConnection with ref set to the connection to
+    // mdnsd shared by all responders of the calling thread, to be or-ed
+    // into the flags of the operation. If no shared connection can be made,
+    // returns 0 and leaves ref null, the operation then makes a connection
+    // of its own.
+    static DNSServiceFlags shareConnection(DNSServiceRef &ref);
+    // Whether the daemon can be reached, as far as can be told without
+    // starting an operation.
+    static bool isAvailable();
 
 protected:
     DNSServiceRef m_ref;
     bool m_running;
-    QSocketNotifier *m_socket;
+
+private Q_SLOTS:
+    // reads the replies of an operation with a connection of its own
+    void process();
+
+private:
+    friend class SharedConnection;
+    // The shared connection went away and took m_ref with it. Reports an
+    // error like a failed operation if report is set.
+    void connectionLost(bool report);
+
+    SharedConnection *m_connection = nullptr;
+    // the socket of an operation that could not share the connection
+    QSocketNotifier *m_socket = nullptr;
+};
+
+// Instead of a socket and a notifier per operation, all responders of a
+// thread run their operations over one connection made with
+// DNSServiceCreateConnection(). Its single socket is read here and the
+// daemon's replies are dispatched to the operations' callbacks by dns_sd.
+// There is one connection per thread, as the callbacks deliver their
+// results with sendEvent() which must not cross threads.
+//
+// Not every implementation of dns_sd.h supports this. avahi-compat-libdns_sd
+// refuses DNSServiceCreateConnection(), there each operation keeps its own
+// socket as it always did.
+class SharedConnection : public QObject
+{
+    Q_OBJECT
+    friend class Responder; // counts the sockets of unshared operations
+public:
+    ~SharedConnection() override;
+
+    // The connection of the calling thread, made on first use.
+    static SharedConnection *self();
+    // Number of sockets the process holds to the daemon.
+    static int socketCount();
+
+    // Connects to the daemon if not connected yet, null if that fails.
+    DNSServiceRef ref();
+    // false if the library does not support shared connections at all
+    bool isSupported() const;
+    void addResponder(Responder *responder);
+    void removeResponder(Responder *responder);
+
+private Q_SLOTS:
+    void process();
+
+private:
+    // Deallocating the connection ends all operations running on it.
+    void close(bool report);
+
+    DNSServiceRef m_ref = nullptr;
+    QSocketNotifier *m_socket = nullptr;
+    QSet<Responder *> m_responders;
+    bool m_unsupported = false;
+    static QAtomicInt s_sockets;
 };
 
 /* Utils functions */
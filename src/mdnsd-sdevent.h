@@ -9,13 +9,14 @@
 #ifndef MDNSD_SDEVENT_H
 #define MDNSD_SDEVENT_H
 
+#include "txtrecord_p.h"
 #include <QEvent>
-#include <QMap>
+#include <QHostAddress>
 #include <QString>
 
 namespace KDNSSD
 {
-enum Operation { SD_ERROR = 101, SD_ADDREMOVE, SD_PUBLISH, SD_RESOLVE };
+enum Operation { SD_ERROR = 101, SD_ADDREMOVE, SD_PUBLISH, SD_RESOLVE, SD_ADDRESS };
 
 class ErrorEvent : public QEvent
 {
@@ -61,7 +62,7 @@ public:
 class ResolveEvent : public QEvent
 {
 public:
-    ResolveEvent(const QString &hostname, unsigned short port, const QMap<QString, QByteArray> &txtdata)
+    ResolveEvent(const QString &hostname, unsigned short port, const TxtRecord &txtdata)
         : QEvent((QEvent::Type)(QEvent::User + SD_RESOLVE))
         , m_hostname(hostname)
         , m_port(port)
@@ -71,7 +72,24 @@ public:
 
     const QString m_hostname;
     const unsigned short m_port;
-    const QMap<QString, QByteArray> m_txtdata;
+    const TxtRecord m_txtdata;
+};
+
+class AddressEvent : public QEvent
+{
+public:
+    enum Operation { Add, Remove };
+    AddressEvent(Operation op, const QHostAddress &address, bool last)
+        : QEvent((QEvent::Type)(QEvent::User + SD_ADDRESS))
+        , m_op(op)
+        , m_address(address)
+        , m_last(last)
+    {
+    }
+
+    const Operation m_op;
+    const QHostAddress m_address;
+    const bool m_last;
 };
 
 }
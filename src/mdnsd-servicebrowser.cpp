@@ -7,17 +7,23 @@
 */
 
 #include "domainbrowser.h"
+#include "hostnameresolver.h"
 #include "mdnsd-responder.h"
 #include "mdnsd-sdevent.h"
 #include "mdnsd-servicebrowser_p.h"
 #include "remoteservice.h"
+#include "resolvescheduler_p.h"
 #include "servicebrowser.h"
+#include "servicecache_p.h"
+#include "stringpool_p.h"
+#include "syncwaiter_p.h"
 #include <QCoreApplication>
 #include <QHash>
 #include <QHostInfo>
 #include <QStringList>
 #include <QTimer>
 #include <dns_sd.h>
+#include <utility>
 
 #define TIMEOUT_WAN 2000
 #define TIMEOUT_LAN 200
@@ -43,15 +49,14 @@ ServiceBrowser::ServiceBrowser(const QString &type, bool autoResolve, const QStr
     d->m_subtype = subtype;
     d->timeout.setSingleShot(true);
     connect(&d->timeout, SIGNAL(timeout()), d, SLOT(onTimeout()));
+    d->m_batchTimer.setSingleShot(true);
+    d->m_batchTimer.setInterval(0);
+    connect(&d->m_batchTimer, &QTimer::timeout, d, &ServiceBrowserPrivate::flushBatch);
 }
 
 ServiceBrowser::State ServiceBrowser::isAvailable()
 {
-    //  DNSServiceRef ref;
-    //  bool ok (DNSServiceCreateConnection(&ref)==kDNSServiceErr_NoError);
-    //  if (ok) DNSServiceRefDeallocate(ref);
-    //  return (ok) ? Working : Stopped;
-    return Working;
+    return Responder::isAvailable() ? Working : Stopped;
 }
 
 ServiceBrowser::~ServiceBrowser() = default;
@@ -62,41 +67,46 @@ bool ServiceBrowser::isAutoResolving() const
     return d->m_autoResolve;
 }
 
-void ServiceBrowserPrivate::serviceResolved(bool success)
+void ServiceBrowserPrivate::serviceResolved(const ServiceKey &key, bool success)
 {
-    QObject *sender_obj = const_cast<QObject *>(sender());
-    RemoteService *svr = static_cast<RemoteService *>(sender_obj);
-    disconnect(svr, SIGNAL(resolved(bool)), this, SLOT(serviceResolved(bool)));
-    QList<RemoteService::Ptr>::Iterator it = m_duringResolve.begin();
-    QList<RemoteService::Ptr>::Iterator itEnd = m_duringResolve.end();
-    while (it != itEnd && svr != (*it).data()) {
-        ++it;
+    auto it = m_services.entries.find(key);
+    if (it == m_services.entries.end() || !it->resolving) {
+        return;
     }
-    if (it != itEnd) {
-        if (success) {
-            m_services += (*it);
-            Q_EMIT m_parent->serviceAdded(RemoteService::Ptr(svr));
-        }
-        m_duringResolve.erase(it);
-        queryFinished();
+    const RemoteService::Ptr svr = it->service;
+    disconnect(svr.data(), &RemoteService::resolved, this, nullptr);
+    --m_resolving;
+    if (success) {
+        it->resolving = false;
+        reportAdded(svr);
+    } else {
+        m_services.erase(it);
     }
+    queryFinished();
 }
 
 void ServiceBrowser::startBrowse()
 {
     Q_D(ServiceBrowser);
-    if (d->isRunning()) {
+    if (d->isRunning() || d->m_paused) {
         return;
     }
     d->m_finished = false;
     DNSServiceRef ref;
+    const DNSServiceFlags share = Responder::shareConnection(ref);
     QString fullType = d->m_type;
     if (!d->m_subtype.isEmpty()) {
         fullType = d->m_subtype + "._sub." + d->m_type;
     }
-    if (DNSServiceBrowse(&ref, 0, 0, fullType.toLatin1().constData(), domainToDNS(d->m_domain).constData(), query_callback, reinterpret_cast<void *>(d))
+    if (DNSServiceBrowse(&ref,
+                         share,
+                         0,
+                         fullType.toLatin1().constData(),
+                         domainToDNS(d->m_domain).constData(),
+                         query_callback,
+                         reinterpret_cast<void *>(d))
         == kDNSServiceErr_NoError) {
-        d->setRef(ref);
+        d->setRef(ref, share);
     }
     if (!d->isRunning()) {
         Q_EMIT finished();
@@ -105,30 +115,223 @@ void ServiceBrowser::startBrowse()
     }
 }
 
+void ServiceBrowser::stopBrowse()
+{
+    Q_D(ServiceBrowser);
+    d->stopBrowse();
+    d->m_services.clear();
+    d->m_batchTimer.stop();
+    d->m_batch.clear();
+    d->m_recovering = false;
+    d->m_paused = false;
+}
+
+void ServiceBrowser::pause()
+{
+    Q_D(ServiceBrowser);
+    if (!d->isRunning()) {
+        return;
+    }
+    d->stopBrowse();
+    d->m_paused = true;
+}
+
+void ServiceBrowser::resume()
+{
+    Q_D(ServiceBrowser);
+    if (!d->m_paused) {
+        return;
+    }
+    d->m_paused = false;
+    // Keep the services and let the browse find them again, they are only
+    // reported if they turn out to be gone.
+    for (ServiceBrowserPrivate::Entry &entry : d->m_services.entries) {
+        entry.stale = true;
+    }
+    d->m_recovering = true;
+    startBrowse();
+}
+
+bool ServiceBrowser::isPaused() const
+{
+    Q_D(const ServiceBrowser);
+    return d->m_paused;
+}
+
+void ServiceBrowserPrivate::stopBrowse()
+{
+    stop();
+    timeout.stop();
+    for (auto it = m_services.entries.begin(); it != m_services.entries.end();) {
+        if (it->resolving) {
+            disconnect(it->service.data(), &RemoteService::resolved, this, nullptr);
+            ResolveScheduler::self()->cancel(it->service);
+            it = m_services.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    m_resolving = 0;
+}
+
 void ServiceBrowserPrivate::queryFinished()
 {
-    if (!m_duringResolve.count() && m_finished) {
+    if (!m_resolving && m_finished) {
+        flushBatch();
         Q_EMIT m_parent->finished();
     }
 }
 
+void ServiceBrowserPrivate::reportAdded(const RemoteService::Ptr &svr)
+{
+    Q_EMIT m_parent->serviceAdded(svr);
+    m_batch.add(svr);
+    m_batchTimer.start();
+}
+
+void ServiceBrowserPrivate::reportRemoved(const RemoteService::Ptr &svr)
+{
+    Q_EMIT m_parent->serviceRemoved(svr);
+    m_batch.remove(svr);
+    m_batchTimer.start();
+}
+
+void ServiceBrowserPrivate::flushBatch()
+{
+    m_batchTimer.stop();
+    const QList<RemoteService::Ptr> removed = m_batch.takeRemoved();
+    if (!removed.isEmpty()) {
+        Q_EMIT m_parent->servicesRemoved(removed);
+    }
+    const QList<RemoteService::Ptr> added = m_batch.takeAdded();
+    if (!added.isEmpty()) {
+        Q_EMIT m_parent->servicesAdded(added);
+    }
+}
+
+RemoteService::Ptr ServiceBrowserPrivate::serviceFor(const Entry &entry, const ServiceKey &key)
+{
+    if (!entry.service) {
+        entry.service = RemoteService::Ptr(new RemoteService(key.name, key.type, key.domain));
+    }
+    return entry.service;
+}
+
 QList<RemoteService::Ptr> ServiceBrowser::services() const
 {
+    // services of record mode entries are created on demand
     Q_D(const ServiceBrowser);
-    return d->m_services;
+    QList<RemoteService::Ptr> services;
+    services.reserve(d->m_services.entries.size() - d->m_resolving);
+    for (const auto &it : d->m_services.inOrder()) {
+        if (!it->resolving) {
+            services.append(d->serviceFor(*it, it.key()));
+        }
+    }
+    return services;
 }
 
-void ServiceBrowser::virtual_hook(int, void *)
+RemoteService::Ptr ServiceBrowser::service(const QString &name) const
 {
+    Q_D(const ServiceBrowser);
+    const auto key = d->m_services.names.constFind(name);
+    if (key == d->m_services.names.constEnd()) {
+        return RemoteService::Ptr();
+    }
+    const auto it = d->m_services.entries.constFind(*key);
+    if (it == d->m_services.entries.cend() || it->resolving) {
+        return RemoteService::Ptr();
+    }
+    return d->serviceFor(*it, it.key());
 }
 
-RemoteService::Ptr ServiceBrowserPrivate::find(RemoteService::Ptr s, const QList<RemoteService::Ptr> &where) const
+QList<ServiceRecord> ServiceBrowser::records() const
 {
-    for (const RemoteService::Ptr &i : where)
-        if (*s == *i) {
-            return i;
+    Q_D(const ServiceBrowser);
+    QList<ServiceRecord> records;
+    records.reserve(d->m_services.entries.size() - d->m_resolving);
+    for (const auto &it : d->m_services.inOrder()) {
+        if (!it->resolving) {
+            records.append(ServiceRecord(it.key().name, it.key().type, it.key().domain));
         }
-    return RemoteService::Ptr();
+    }
+    return records;
+}
+
+void ServiceBrowser::setRecordMode(bool enable)
+{
+    Q_D(ServiceBrowser);
+    d->m_recordMode = enable;
+}
+
+bool ServiceBrowser::isRecordMode() const
+{
+    Q_D(const ServiceBrowser);
+    return d->m_recordMode;
+}
+
+void ServiceBrowser::virtual_hook(int, void *)
+{
+}
+
+void ServiceBrowserPrivate::gotNewService(const QString &name, const QString &type, const QString &domain)
+{
+    const ServiceKey key(name, type, domain);
+    auto it = m_services.entries.find(key);
+    if (it != m_services.entries.end()) {
+        it->stale = false;
+        return;
+    }
+
+    if (m_recordMode && !m_autoResolve) {
+        m_services.insert(key);
+        Q_EMIT m_parent->recordAdded(ServiceRecord(name, type, domain));
+        return;
+    }
+
+    RemoteService::Ptr svr(new RemoteService(name, type, domain));
+    Entry &entry = m_services.insert(key);
+    entry.service = svr;
+    // no need to resolve what was resolved before already
+    if (m_autoResolve && !svr->isResolved()) {
+        entry.resolving = true;
+        ++m_resolving;
+        connect(svr.data(), &RemoteService::resolved, this, [this, key](bool success) {
+            serviceResolved(key, success);
+        });
+        ResolveScheduler::self()->enqueue(svr);
+    } else {
+        reportAdded(svr);
+    }
+}
+
+void ServiceBrowserPrivate::gotRemoveService(const QString &name, const QString &type, const QString &domain)
+{
+    ServiceCache::self()->remove(name, type, domain);
+    const ServiceKey key(name, type, domain);
+    auto it = m_services.entries.find(key);
+    if (it == m_services.entries.end()) {
+        return;
+    }
+
+    if (m_recordMode && !m_autoResolve) {
+        Q_EMIT m_parent->recordRemoved(ServiceRecord(name, type, domain));
+        m_services.erase(it);
+        return;
+    }
+
+    const RemoteService::Ptr found = it->service;
+    if (it->resolving) {
+        disconnect(found.data(), &RemoteService::resolved, this, nullptr);
+        ResolveScheduler::self()->cancel(found);
+        --m_resolving;
+        m_services.erase(it);
+        return;
+    }
+
+    // a slot connected to the removal may look at services() already
+    m_services.erase(it);
+    reportRemoved(found);
 }
 
 void ServiceBrowserPrivate::customEvent(QEvent *event)
@@ -141,27 +344,18 @@ void ServiceBrowserPrivate::customEvent(QEvent *event)
     if (event->type() == QEvent::User + SD_ADDREMOVE) {
         AddRemoveEvent *aev = static_cast<AddRemoveEvent *>(event);
         // m_type has useless trailing dot
-        RemoteService::Ptr svr(new RemoteService(aev->m_name, aev->m_type.left(aev->m_type.length() - 1), aev->m_domain));
+        const QString type = aev->m_type.left(aev->m_type.length() - 1);
         if (aev->m_op == AddRemoveEvent::Add) {
-            if (m_autoResolve) {
-                connect(svr.data(), SIGNAL(resolved(bool)), this, SLOT(serviceResolved(bool)));
-                m_duringResolve += svr;
-                svr->resolveAsync();
-            } else {
-                m_services += svr;
-                Q_EMIT m_parent->serviceAdded(svr);
-            }
+            // type and domain are the same for most services, share them
+            gotNewService(aev->m_name, StringPool::self()->intern(type), StringPool::self()->intern(aev->m_domain));
         } else {
-            RemoteService::Ptr found = find(svr, m_duringResolve);
-            if (found) {
-                m_duringResolve.removeAll(found);
-            } else {
-                found = find(svr, m_services);
-                if (found) {
-                    Q_EMIT m_parent->serviceRemoved(found);
-                    m_services.removeAll(found);
-                }
-            }
+            gotRemoveService(aev->m_name, type, aev->m_domain);
+        }
+        // hold the batch back until the daemon has nothing more to report
+        if (!aev->m_last) {
+            m_batchTimer.stop();
+        } else if (!m_batch.isEmpty()) {
+            m_batchTimer.start();
         }
         m_finished = aev->m_last;
         if (m_finished) {
@@ -172,6 +366,19 @@ void ServiceBrowserPrivate::customEvent(QEvent *event)
 
 void ServiceBrowserPrivate::onTimeout()
 {
+    // The first answer of the daemon need not hold all it knows, so only
+    // once the browse had its time are services not found again gone.
+    if (std::exchange(m_recovering, false)) {
+        QList<ServiceKey> gone;
+        for (auto it = m_services.entries.cbegin(); it != m_services.entries.cend(); ++it) {
+            if (it->stale) {
+                gone.append(it.key());
+            }
+        }
+        for (const ServiceKey &key : std::as_const(gone)) {
+            gotRemoveService(key.name, key.type, key.domain);
+        }
+    }
     m_finished = true;
     queryFinished();
 }
@@ -199,10 +406,16 @@ void query_callback(DNSServiceRef,
     }
 }
 
-// TODO: Please Implement Me - Using a KResolver (if not natively)
 QHostAddress ServiceBrowser::resolveHostName(const QString &hostname)
 {
-    return QHostAddress();
+    HostNameResolver resolver(hostname);
+    SyncWaiter waiter(&resolver, &HostNameResolver::resolved);
+    resolver.resolveAsync();
+    // the lookup gives up on its own, no deadline needed
+    if (waiter.wait(QDeadlineTimer(QDeadlineTimer::Forever)) != ServiceBase::Succeeded) {
+        return QHostAddress();
+    }
+    return resolver.addresses().constFirst();
 }
 
 QString ServiceBrowser::getLocalHostName()
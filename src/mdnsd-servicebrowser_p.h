@@ -9,10 +9,14 @@
 #ifndef MDNSD_SERVICEBROWSER_P_H
 #define MDNSD_SERVICEBROWSER_P_H
 
+#include <QHash>
 #include <QObject>
 #include <QTimer>
 
+#include "browsedservices_p.h"
 #include "mdnsd-responder.h"
+#include "resolvescheduler_p.h"
+#include "servicebase_p.h"
 #include "servicebrowser.h"
 
 namespace KDNSSD
@@ -26,22 +30,59 @@ public:
         , m_parent(parent)
     {
     }
-    QList<RemoteService::Ptr> m_services;
-    QList<RemoteService::Ptr> m_duringResolve;
+    ~ServiceBrowserPrivate() override
+    {
+        for (const Entry &entry : std::as_const(m_services.entries)) {
+            if (entry.resolving) {
+                ResolveScheduler::self()->cancel(entry.service);
+            }
+        }
+    }
+    struct Entry {
+        // null for services not asked for yet in record mode, the const
+        // accessors of ServiceBrowser create it on demand
+        mutable RemoteService::Ptr service;
+        bool resolving = false;
+        // see BrowsedServices
+        quint64 found = 0;
+        // known from before browsing was paused, not found again yet
+        bool stale = false;
+    };
+    BrowsedServices<Entry> m_services;
+    int m_resolving = 0;
+    bool m_recordMode = false;
+
+    // creates the service object of a record mode entry on first use
+    static RemoteService::Ptr serviceFor(const Entry &entry, const ServiceKey &key);
+
+    ServiceBatch m_batch;
+    QTimer m_batchTimer;
+
+    // emit the per-service signal and queue the service for the batched one
+    void reportAdded(const RemoteService::Ptr &svr);
+    void reportRemoved(const RemoteService::Ptr &svr);
+    void flushBatch();
     QString m_type;
     QString m_domain;
     QString m_subtype;
     bool m_autoResolve;
     bool m_finished;
+    bool m_paused = false;
+    // Set while browsing again after a pause. Entries still stale when the
+    // browse times out are removed then.
+    bool m_recovering = false;
     ServiceBrowser *m_parent;
     QTimer timeout;
 
-    // get already found service identical to s or null if not found
-    RemoteService::Ptr find(RemoteService::Ptr s, const QList<RemoteService::Ptr> &where) const;
+    // Stops the browse. Services still being resolved are dropped, they are
+    // found again by the next one.
+    void stopBrowse();
+    void serviceResolved(const ServiceKey &key, bool success);
+    void gotNewService(const QString &name, const QString &type, const QString &domain);
+    void gotRemoveService(const QString &name, const QString &type, const QString &domain);
     virtual void customEvent(QEvent *event);
 public Q_SLOTS:
     void queryFinished();
-    void serviceResolved(bool success);
     void onTimeout();
 };
 
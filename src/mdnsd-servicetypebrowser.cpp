@@ -37,6 +37,31 @@ void ServiceTypeBrowser::startBrowse()
     d->m_browser->startBrowse();
 }
 
+void ServiceTypeBrowser::stopBrowse()
+{
+    Q_D(ServiceTypeBrowser);
+    d->m_browser->stopBrowse();
+    d->m_servicetypes.clear();
+}
+
+void ServiceTypeBrowser::pause()
+{
+    Q_D(ServiceTypeBrowser);
+    d->m_browser->pause();
+}
+
+void ServiceTypeBrowser::resume()
+{
+    Q_D(ServiceTypeBrowser);
+    d->m_browser->resume();
+}
+
+bool ServiceTypeBrowser::isPaused() const
+{
+    Q_D(const ServiceTypeBrowser);
+    return d->m_browser->isPaused();
+}
+
 void ServiceTypeBrowserPrivate::newService(KDNSSD::RemoteService::Ptr srv)
 {
     QString type = srv->serviceName() + '.' + srv->type();
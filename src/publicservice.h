@@ -43,6 +43,10 @@ class PublicServicePrivate;
  * connect(service, SIGNAL(published(bool)), this, SLOT(wasPublished(bool)));
  * service->publishAsync();
  * \endcode
+ *
+ * Changes made to a service that is already published are applied once
+ * control returns to the event loop. Setting several properties in a row
+ * therefore re-announces the service only once.
  */
 class KDNSSD_EXPORT PublicService : public QObject, public ServiceBase
 {
@@ -111,6 +115,28 @@ public:
      */
     bool publish();
 
+    /*!
+     * Publishes the service synchronously, giving up at \a deadline.
+     *
+     * Works like publish(), but does not wait forever for a daemon that
+     * stops answering.
+     *
+     * The daemon reports the outcome with signals, so while waiting the
+     * calling thread sleeps in a local event loop that handles all events
+     * of that thread except for user input: timers, socket notifiers and
+     * queued slot calls of the application may run before this function
+     * returns. Do not call it from code that cannot be re-entered.
+     *
+     * When the deadline expires, publishing is stopped.
+     *
+     * Returns ServiceBase::Succeeded if the service was published,
+     * ServiceBase::Failed if publishing failed or was stopped, or
+     * ServiceBase::TimedOut if there was no result in time
+     *
+     * \since 6.28
+     */
+    WaitResult publish(QDeadlineTimer deadline);
+
     /*!
      * Whether the service is currently published.
      *
@@ -132,8 +158,8 @@ public:
     /*!
      * Sets new text properties.
      *
-     * If the service is already published, it will be re-announced with
-     * the new data.
+     * If the service is already published, its text properties are
+     * updated in place, without withdrawing the service.
      *
      * \a textData is the new text properties for the service
      *
@@ -215,6 +241,10 @@ Q_SIGNALS:
      * It will also emitted when an already-published service is
      * republished after a property of the service (such as the
      * name or port) is changed.
+     *
+     * If the mDNS daemon is restarted while the service is published, this
+     * is emitted with \c false, and with \c true again once the service is
+     * registered with the new daemon.
      */
     void published(bool successful);
 
@@ -223,6 +253,7 @@ protected:
 
 private:
     friend class PublicServicePrivate;
+    friend class PublicServiceGroupPrivate;
 };
 
 }
@@ -0,0 +1,136 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KDNSSDPUBLICSERVICEGROUP_H
+#define KDNSSDPUBLICSERVICEGROUP_H
+
+#include "kdnssd_export.h"
+#include <QList>
+#include <QObject>
+
+#include <memory>
+
+namespace KDNSSD
+{
+class PublicService;
+class PublicServiceGroupPrivate;
+
+/*!
+ * \class KDNSSD::PublicServiceGroup
+ * \inmodule KDNSSD
+ * \inheaderfile KDNSSD/PublicServiceGroup
+ *
+ * \brief Publishes many services together.
+ *
+ * Publishing a PublicService on its own costs a separate registration
+ * and probe cycle for every service. Applications announcing a large
+ * number of services should instead add them to a PublicServiceGroup,
+ * which publishes all of them at once. On the Avahi backend this uses a
+ * single entry group that is committed once.
+ *
+ * \code
+ * KDNSSD::PublicServiceGroup *group = new KDNSSD::PublicServiceGroup(this);
+ * for (const Device &device : devices) {
+ *     group->addService(new KDNSSD::PublicService(device.name, "_http._tcp", device.port));
+ * }
+ * connect(group, &KDNSSD::PublicServiceGroup::published, this, &Gateway::announced);
+ * group->publishAsync();
+ * \endcode
+ *
+ * The PublicService objects only describe the services, they must not be
+ * published on their own while they are members of a group. When the
+ * name of a member is already taken, that member is renamed as a
+ * PublicService would be, the others keep their names. The new name can
+ * be read from PublicService::serviceName().
+ *
+ * \note When a conflict is only detected while probing the network, Avahi
+ * cannot tell which member of the group caused it, so all members move on
+ * to an alternative name.
+ *
+ * \since 6.28
+ */
+class KDNSSD_EXPORT PublicServiceGroup : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * Creates an empty group with the given \a parent.
+     */
+    explicit PublicServiceGroup(QObject *parent = nullptr);
+
+    /*!
+     * Withdraws the services if they are published.
+     *
+     * The member services are not deleted.
+     */
+    ~PublicServiceGroup() override;
+
+    /*!
+     * Adds \a service to the group.
+     *
+     * The group does not take ownership of \a service, a member that is
+     * deleted is removed from the group. If the group is already
+     * published, all services are published again together with the new
+     * one.
+     */
+    void addService(PublicService *service);
+
+    /*!
+     * Removes \a service from the group.
+     *
+     * If the group is published, the remaining services are published
+     * again without it.
+     */
+    void removeService(PublicService *service);
+
+    /*!
+     * Returns the services of this group.
+     */
+    QList<PublicService *> services() const;
+
+    /*!
+     * Publishes all services of the group asynchronously.
+     *
+     * Returns immediately and emits published() when completed.
+     */
+    void publishAsync();
+
+    /*!
+     * Stops publishing all services of the group.
+     */
+    void stop();
+
+    /*!
+     * Whether all services of the group are currently published.
+     */
+    bool isPublished() const;
+
+Q_SIGNALS:
+    /*!
+     * Emitted when publishing is complete.
+     *
+     * \a successful is \c true if all services of the group were
+     * published, \c false if publishing any of them failed. In that case
+     * none of the services stay published.
+     *
+     * If the mDNS daemon is restarted while the group is published, this
+     * is emitted with \c false, and with \c true again once the group is
+     * registered with the new daemon.
+     */
+    void published(bool successful);
+
+private:
+    friend class PublicServiceGroupPrivate;
+    std::unique_ptr<PublicServiceGroupPrivate> const d;
+    Q_DECLARE_PRIVATE_D(d, PublicServiceGroup)
+};
+
+}
+
+#endif
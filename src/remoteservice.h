@@ -43,6 +43,24 @@ class KDNSSD_EXPORT RemoteService : public QObject, public ServiceBase
 public:
     typedef QExplicitlySharedDataPointer<RemoteService> Ptr;
 
+    /*!
+     * \enum KDNSSD::RemoteService::ResolveMode
+     * \brief How resolveAsync() obtains the service details.
+     *
+     * \value ResolveOnce
+     * Look up host name, port and text data once. This is the cheapest
+     * way of resolving and the default.
+     * \value Monitor
+     * Keep watching the service after it has been resolved and re-emit
+     * resolved() whenever its host name, port or text data change.
+     *
+     * \since 6.28
+     */
+    enum ResolveMode {
+        ResolveOnce,
+        Monitor,
+    };
+
     /*!
      * Creates an unresolved RemoteService representing the service with
      * the given name, type and domain.
@@ -69,13 +87,14 @@ public:
      * resolution is complete, or when it fails.
      *
      * \note resolved() may be emitted before this function
-     * returns in case of immediate failure.
+     * returns in case of immediate failure, or when the service
+     * was resolved recently and its details are still cached.
      *
-     * RemoteService will keep monitoring the service for
-     * changes in hostname and port, and re-emit resolved()
-     * when either changes.
+     * If resolveMode() is \l Monitor, RemoteService will keep
+     * monitoring the service for changes in hostname, port and
+     * text data, and re-emit resolved() when any of them changes.
      *
-     * \sa resolve(), hostName(), port()
+     * \sa resolve(), setResolveMode(), hostName(), port()
      */
     void resolveAsync();
 
@@ -96,19 +115,72 @@ public:
      */
     bool resolve();
 
+    /*!
+     * Resolves the service synchronously, giving up at \a deadline.
+     *
+     * Works like resolve(), but does not wait forever for a daemon that
+     * stops answering:
+     * \code
+     * if (service->resolve(QDeadlineTimer(2000)) == KDNSSD::RemoteService::TimedOut) {
+     *     // the daemon did not answer within two seconds
+     * }
+     * \endcode
+     *
+     * With the default ResolveOnce mode, the Avahi backend waits for the
+     * reply of the daemon without processing any events. Otherwise the
+     * calling thread sleeps in a local event loop that handles all events
+     * of that thread except for user input: timers, socket notifiers and
+     * queued slot calls of the application may run before this function
+     * returns. Do not call it from code that cannot be re-entered.
+     *
+     * When the deadline expires, the resolve request is stopped.
+     *
+     * Returns ServiceBase::Succeeded if the service was resolved,
+     * ServiceBase::Failed if resolving failed, or ServiceBase::TimedOut if
+     * there was no result in time
+     *
+     * \sa resolveAsync()
+     * \since 6.28
+     */
+    WaitResult resolve(QDeadlineTimer deadline);
+
     /*!
      * Whether the service has been successfully resolved.
      *
+     * A newly created RemoteService is already resolved if the same
+     * service has been resolved recently within this process.
+     *
      * Returns \c true if hostName() and port() will return
      *         valid values, \c false otherwise
      */
     bool isResolved() const;
 
+    /*!
+     * Sets how the service is resolved by the next call to resolveAsync().
+     *
+     * Use \l Monitor if you need to be notified about changes of the
+     * service, e.g. of its text data, after it has been resolved.
+     *
+     * \a mode is the resolve mode, the default is \l ResolveOnce
+     *
+     * \since 6.28
+     */
+    void setResolveMode(ResolveMode mode);
+
+    /*!
+     * Returns the mode used by resolveAsync().
+     *
+     * \sa setResolveMode()
+     *
+     * \since 6.28
+     */
+    ResolveMode resolveMode() const;
+
 Q_SIGNALS:
     /*!
      * Emitted when resolving is complete
      *
-     * If operating in asynchronous mode this signal can be
+     * If resolving in \l Monitor mode this signal can be
      * emitted several times (when the hostName or port of
      * the service changes).
      *
@@ -123,6 +195,7 @@ protected:
 
 private:
     friend class RemoteServicePrivate;
+    friend class ResolveScheduler;
 };
 
 }
@@ -0,0 +1,116 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "resolvescheduler_p.h"
+#include "kdnssd_debug.h"
+#include "servicebrowser.h"
+#include <QThreadStorage>
+
+#include <algorithm>
+#include <atomic>
+
+namespace KDNSSD
+{
+static QThreadStorage<ResolveScheduler *> s_schedulers;
+static std::atomic<int> s_maxInFlight{32};
+
+ResolveScheduler::ResolveScheduler()
+{
+}
+
+ResolveScheduler::~ResolveScheduler()
+{
+}
+
+ResolveScheduler *ResolveScheduler::self()
+{
+    if (!s_schedulers.hasLocalData()) {
+        s_schedulers.setLocalData(new ResolveScheduler);
+    }
+    return s_schedulers.localData();
+}
+
+void ResolveScheduler::setMaximumInFlight(int limit)
+{
+    s_maxInFlight = qMax(1, limit);
+    // the schedulers of other threads follow once one of their resolves ends
+    if (s_schedulers.hasLocalData()) {
+        s_schedulers.localData()->startQueued();
+    }
+}
+
+int ResolveScheduler::maximumInFlight()
+{
+    return s_maxInFlight;
+}
+
+void ResolveScheduler::enqueue(const RemoteService::Ptr &svr)
+{
+    if (m_queued.contains(svr.data()) || m_inFlight.contains(svr.data())) {
+        return;
+    }
+    QElapsedTimer queuedSince;
+    queuedSince.start();
+    m_queued.insert(svr.data(), queuedSince);
+    m_queue.push_back(svr);
+    startQueued();
+}
+
+void ResolveScheduler::cancel(const RemoteService::Ptr &svr)
+{
+    if (m_queued.remove(svr.data())) {
+        // enqueueing it again has to put it at the end of the queue
+        const auto it = std::find(m_queue.begin(), m_queue.end(), svr);
+        Q_ASSERT(it != m_queue.end());
+        m_queue.erase(it);
+        return;
+    }
+    if (m_inFlight.remove(svr.data())) {
+        disconnect(svr.data(), &RemoteService::resolved, this, nullptr);
+        // the slot is only free once the daemon stopped working on it
+        stopResolve(svr.data());
+        startQueued();
+    }
+}
+
+void ResolveScheduler::serviceResolved()
+{
+    RemoteService *svr = static_cast<RemoteService *>(sender());
+    disconnect(svr, &RemoteService::resolved, this, nullptr);
+    m_inFlight.remove(svr);
+    startQueued();
+}
+
+void ResolveScheduler::startQueued()
+{
+    while (m_inFlight.size() < s_maxInFlight && !m_queue.empty()) {
+        const RemoteService::Ptr svr = m_queue.front();
+        m_queue.pop_front();
+        const qint64 waited = m_queued.take(svr.data()).elapsed();
+
+        qCDebug(KDNSSD_LOG) << "Resolving" << svr->serviceName() << svr->type() << "after waiting" << waited << "ms," << m_queued.size() << "queued,"
+                            << m_inFlight.size() + 1 << "in flight";
+        m_inFlight.insert(svr.data(), svr);
+        connect(svr.data(), &RemoteService::resolved, this, &ResolveScheduler::serviceResolved);
+        svr->resolveAsync();
+    }
+}
+
+void ServiceBrowser::setMaximumConcurrentResolves(int limit)
+{
+    ResolveScheduler::setMaximumInFlight(limit);
+}
+
+int ServiceBrowser::maximumConcurrentResolves()
+{
+    return ResolveScheduler::maximumInFlight();
+}
+
+}
+
+#include "moc_resolvescheduler_p.cpp"
@@ -0,0 +1,60 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef RESOLVESCHEDULER_P_H
+#define RESOLVESCHEDULER_P_H
+
+#include "remoteservice.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <deque>
+
+namespace KDNSSD
+{
+// Resolves the services found by auto-resolving browsers, shared by all
+// browsers of a thread. Only a limited number of resolves is in flight at
+// any time, the rest waits in FIFO order so that a browse storm does not
+// flood the daemon.
+// There is one scheduler per thread, like the services it resolves it is
+// only used from the thread it lives in.
+class ResolveScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    ResolveScheduler();
+    ~ResolveScheduler() override;
+
+    // the scheduler of the current thread
+    static ResolveScheduler *self();
+
+    // the limit is the same for the schedulers of all threads
+    static void setMaximumInFlight(int limit);
+    static int maximumInFlight();
+
+    // Calls resolveAsync() on svr as soon as there is a free slot.
+    void enqueue(const RemoteService::Ptr &svr);
+    // Drops svr from the queue, or frees its slot if it is being resolved.
+    void cancel(const RemoteService::Ptr &svr);
+
+private:
+    void serviceResolved();
+    void startQueued();
+    // Stops a resolve started by resolveAsync(), without emitting
+    // resolved(). Implemented by each backend.
+    static void stopResolve(RemoteService *svr);
+
+    // m_queued holds the same services as m_queue, for fast lookups
+    std::deque<RemoteService::Ptr> m_queue;
+    QHash<RemoteService *, QElapsedTimer> m_queued;
+    QHash<RemoteService *, RemoteService::Ptr> m_inFlight;
+};
+
+}
+
+#endif
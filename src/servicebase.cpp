@@ -9,6 +9,7 @@
 #include "servicebase.h"
 #include "servicebase_p.h"
 #include <QDataStream>
+#include <QHash>
 #include <QUrl>
 
 namespace KDNSSD
@@ -51,7 +52,27 @@ unsigned short ServiceBase::port() const
 }
 QMap<QString, QByteArray> ServiceBase::textData() const
 {
-    return d->m_textData;
+    return d->m_textData.toMap();
+}
+
+QByteArrayView ServiceBase::textValue(QByteArrayView key) const
+{
+    return d->m_textData.value(key);
+}
+
+qsizetype ServiceBase::textDataCount() const
+{
+    return d->m_textData.size();
+}
+
+QByteArrayView ServiceBase::textKeyAt(qsizetype i) const
+{
+    return d->m_textData.keyAt(i);
+}
+
+QByteArrayView ServiceBase::textValueAt(qsizetype i) const
+{
+    return d->m_textData.valueAt(i);
 }
 
 bool ServiceBase::operator==(const ServiceBase &o) const
@@ -68,6 +89,11 @@ void ServiceBase::virtual_hook(int, void *)
 {
 }
 
+size_t qHash(const ServiceBase &service, size_t seed) noexcept
+{
+    return qHashMulti(seed, service.d->m_serviceName, service.d->m_type, service.d->m_domain);
+}
+
 bool domainIsLocal(const QString &domain)
 {
     return domain.section(QLatin1Char('.'), -1, -1).toLower() == QLatin1String("local");
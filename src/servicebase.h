@@ -10,6 +10,8 @@
 #define KDNSSDSERVICEBASE_H
 
 #include "kdnssd_export.h"
+#include <QByteArrayView>
+#include <QDeadlineTimer>
 #include <QExplicitlySharedDataPointer>
 #include <QMap>
 #include <QString>
@@ -22,8 +24,21 @@
  */
 namespace KDNSSD
 {
+class ServiceBase;
 class ServiceBasePrivate;
 
+/*!
+ * \relates KDNSSD::ServiceBase
+ *
+ * Returns the hash value for \a service, using \a seed to seed the calculation.
+ *
+ * Like ServiceBase::operator==() only name, type and domain are taken into
+ * account, so services can be used as keys in QHash or QSet.
+ *
+ * \since 6.28
+ */
+KDNSSD_EXPORT size_t qHash(const ServiceBase &service, size_t seed = 0) noexcept;
+
 /*!
  * \class KDNSSD::ServiceBase
  * \inmodule KDNSSD
@@ -48,6 +63,26 @@ class KDNSSD_EXPORT ServiceBase : public QSharedData // krazy:exclude=dpointer (
 public:
     typedef QExplicitlySharedDataPointer<ServiceBase> Ptr;
 
+    /*!
+     * \enum KDNSSD::ServiceBase::WaitResult
+     * \brief The outcome of RemoteService::resolve() and
+     * PublicService::publish() when they are given a deadline.
+     *
+     * \value Succeeded
+     * The service was resolved or published.
+     * \value Failed
+     * Resolving or publishing failed, or was stopped.
+     * \value TimedOut
+     * There was no result before the deadline expired.
+     *
+     * \since 6.28
+     */
+    enum WaitResult {
+        Succeeded,
+        Failed,
+        TimedOut,
+    };
+
     /*!
      * Creates a ServiceBase object
      *
@@ -154,10 +189,62 @@ public:
      *
      * \note You actually have to be
      * a bit more clever than this, since the key should usually be case
-     * insensitive.
+     * insensitive. textValue() does that for you and also avoids building
+     * the map.
      */
     QMap<QString, QByteArray> textData() const;
 
+    /*!
+     * Returns the value of the text data entry \a key.
+     *
+     * Keys are compared case insensitively, and if a key appears more than
+     * once the first entry is used, as required by RFC 6763.
+     *
+     * Returns a null view if there is no such entry. An entry without a
+     * value (one without an \c = in it) gives an empty view that is not
+     * null.
+     *
+     * The returned view points into the data held by this service and
+     * stays valid until the service is resolved or its text data is set
+     * again. No memory is allocated.
+     *
+     * \sa textData()
+     * \since 6.28
+     */
+    QByteArrayView textValue(QByteArrayView key) const;
+
+    /*!
+     * Returns the number of text data entries.
+     *
+     * Together with textKeyAt() and textValueAt() this allows walking all
+     * entries without allocating memory, in the order they were received.
+     *
+     * \sa textData()
+     * \since 6.28
+     */
+    qsizetype textDataCount() const;
+
+    /*!
+     * Returns the key of the text data entry at index \a i, which must be
+     * in the range from 0 to textDataCount() - 1.
+     *
+     * \sa textValueAt()
+     * \since 6.28
+     */
+    QByteArrayView textKeyAt(qsizetype i) const;
+
+    /*!
+     * Returns the value of the text data entry at index \a i, which must be
+     * in the range from 0 to textDataCount() - 1.
+     *
+     * As for textValue(), an entry without a value gives an empty view
+     * that is not null.
+     *
+     * \sa textKeyAt()
+     * \since 6.28
+     */
+    QByteArrayView textValueAt(qsizetype i) const;
+
     /*!
      * Compares services based on name, type and domain.
      *
@@ -191,6 +278,8 @@ public:
 protected:
     KDNSSD_NO_EXPORT explicit ServiceBase(ServiceBasePrivate *const d);
 
+    friend size_t qHash(const ServiceBase &service, size_t seed) noexcept;
+
     virtual void virtual_hook(int, void *);
 
 protected:
@@ -9,11 +9,41 @@
 #ifndef SERVICEBASE_P_H
 #define SERVICEBASE_P_H
 
-#include <QMap>
+#include "txtrecord_p.h"
+#include <QHash>
 #include <QString>
 
 namespace KDNSSD
 {
+/**
+Identity of a service as used for indexing, with the hash computed only once.
+ */
+struct ServiceKey {
+    ServiceKey() = default;
+    ServiceKey(const QString &name, const QString &type, const QString &domain)
+        : name(name)
+        , type(type)
+        , domain(domain)
+        , hash(qHashMulti(QHashSeed::globalSeed(), name, type, domain))
+    {
+    }
+
+    bool operator==(const ServiceKey &o) const
+    {
+        return hash == o.hash && name == o.name && type == o.type && domain == o.domain;
+    }
+
+    friend size_t qHash(const ServiceKey &key, size_t seed = 0)
+    {
+        return qHash(key.hash, seed);
+    }
+
+    QString name;
+    QString type;
+    QString domain;
+    size_t hash = 0;
+};
+
 class ServiceBasePrivate
 {
 public:
@@ -37,9 +67,9 @@ public:
     unsigned short m_port;
 
     /**
-    Map of TXT properties
+    TXT properties
      */
-    QMap<QString, QByteArray> m_textData;
+    TxtRecord m_textData;
 };
 }
 #endif
@@ -10,8 +10,10 @@
 #define KDNSSDSERVICEBROWSER_H
 
 #include "remoteservice.h"
+#include "servicerecord.h"
 #include <QHostAddress>
 #include <QObject>
+#include <QSharedPointer>
 
 #include <memory>
 
@@ -51,6 +53,10 @@ class ServiceBrowserPrivate;
  * Because no domain was passed to constructor, the default domain
  * will be searched.  To find other domains to browse for services on,
  * use DomainBrowser.
+ *
+ * When the Avahi daemon is restarted, browsing resumes by itself. Services
+ * found again are not reported a second time, only those that are gone
+ * by then are removed.
  */
 class KDNSSD_EXPORT ServiceBrowser : public QObject
 {
@@ -118,16 +124,33 @@ public:
      *
      * Returns a list of RemoteService pointers
      *
+     * In record mode this creates a RemoteService object for every known
+     * service, records() is usually the better choice there.
+     *
      * \sa serviceAdded() and serviceRemoved()
      */
     QList<RemoteService::Ptr> services() const;
 
+    /*!
+     * Returns the currently known service called \a name, or a null
+     * pointer if there is none.
+     *
+     * Unlike searching services(), this is a constant time lookup and does
+     * not copy the list of services. In record mode the RemoteService
+     * object is created by the first call for a service.
+     *
+     * \sa services()
+     * \since 6.28
+     */
+    RemoteService::Ptr service(const QString &name) const;
+
     /*!
      * Starts browsing for services.
      *
-     * \note Only the first call to this function will have any effect.
+     * \note This has no effect while browsing is running or paused.
      *
-     * Browsing stops when the ServiceBrowser object is destroyed.
+     * Browsing stops when the ServiceBrowser object is destroyed or
+     * stopBrowse() is called.
      *
      * \warning The serviceAdded() signal may be emitted before this
      *          function returns.
@@ -136,6 +159,54 @@ public:
      */
     virtual void startBrowse();
 
+    /*!
+     * Stops browsing.
+     *
+     * Everything held in the DNS-SD daemon on behalf of this browser is
+     * freed and the services found so far are forgotten, serviceRemoved()
+     * is not emitted for them. Browsing can be started again with
+     * startBrowse().
+     *
+     * \sa pause()
+     * \since 6.28
+     */
+    void stopBrowse();
+
+    /*!
+     * Suspends browsing, e.g. while the view showing the results is hidden.
+     *
+     * Like stopBrowse() this frees everything held in the DNS-SD daemon,
+     * so a paused browser puts no load on it. The services found so far
+     * are kept though and can still be read from services(). Services that
+     * are still being resolved are dropped, they are found again on
+     * resume().
+     *
+     * \sa resume() and isPaused()
+     * \since 6.28
+     */
+    void pause();
+
+    /*!
+     * Continues browsing after pause().
+     *
+     * The services known from before are not reported again, only the
+     * changes are: serviceAdded() for those that appeared in the meantime
+     * and serviceRemoved() for those that are not found again by the time
+     * finished() is emitted. In record mode these are recordAdded() and
+     * recordRemoved().
+     *
+     * \since 6.28
+     */
+    void resume();
+
+    /*!
+     * Whether browsing is paused.
+     *
+     * \sa pause()
+     * \since 6.28
+     */
+    bool isPaused() const;
+
     /*!
      * Checks availability of DNS-SD services.
      *
@@ -176,6 +247,9 @@ public:
      * }
      * \endcode
      *
+     * Only the first call asks the daemon, after that the state is tracked
+     * and this is cheap enough to be called as often as needed.
+     *
      * Returns the mDNS-SD service state.
      */
     static State isAvailable();
@@ -189,6 +263,47 @@ public:
      */
     bool isAutoResolving() const;
 
+    /*!
+     * Enables or disables record mode.
+     *
+     * In record mode found services are kept as plain ServiceRecord values
+     * and reported with recordAdded() and recordRemoved() only. A
+     * RemoteService object is created for a service only when it is asked
+     * for with service() or services(). This makes browsing much cheaper
+     * for tools that merely list service instances.
+     *
+     * serviceAdded(), serviceRemoved(), servicesAdded() and
+     * servicesRemoved() are not emitted in record mode, so the browser
+     * cannot be used with ServiceModel.
+     *
+     * Record mode has no effect on auto-resolving browsers, and has to be
+     * chosen before calling startBrowse().
+     *
+     * \sa records()
+     * \since 6.28
+     */
+    void setRecordMode(bool enable);
+
+    /*!
+     * Whether this browser is in record mode.
+     *
+     * \sa setRecordMode()
+     * \since 6.28
+     */
+    bool isRecordMode() const;
+
+    /*!
+     * The currently known services of the specified type, as plain
+     * records.
+     *
+     * This works in either mode but is meant for record mode, where it does
+     * not create any RemoteService objects.
+     *
+     * \sa setRecordMode() and services()
+     * \since 6.28
+     */
+    QList<ServiceRecord> records() const;
+
     /*!
      * Resolves an mDNS hostname into an IP address.
      *
@@ -202,6 +317,9 @@ public:
      * Returns a QHostAddress containing the IP address, or QHostAddress() if
      *         resolution failed
      *
+     * \note This blocks until the host answered. Use HostNameResolver to
+     * look up hosts asynchronously and to get all of their addresses.
+     *
      * \since 4.2
      */
     static QHostAddress resolveHostName(const QString &hostname);
@@ -212,6 +330,7 @@ public:
      * Usually this will return the same as QHostInfo::localHostName(),
      * but it may be changed to something different
      * in the Avahi configuration file (if using the Avahi backend).
+     * Like isAvailable() this is answered from memory after the first call.
      *
      * Returns the hostname, or an empty string on failure
      *
@@ -219,6 +338,96 @@ public:
      */
     static QString getLocalHostName();
 
+    /*!
+     * Limits how many services found by auto-resolving browsers are
+     * resolved at the same time.
+     *
+     * The limit is shared by all ServiceBrowser instances of a thread,
+     * browsers in different threads each get the full limit. Services
+     * discovered while the limit is reached wait in a queue and
+     * are resolved in the order they were found. Services that disappear
+     * before their turn are dropped from the queue.
+     *
+     * Queue depth and waiting times are reported in the \c kf.dnssd
+     * logging category, which helps tuning the limit.
+     *
+     * \a limit is the maximum number of resolves in flight, at least 1
+     *
+     * \sa isAutoResolving()
+     *
+     * \since 6.28
+     */
+    static void setMaximumConcurrentResolves(int limit);
+
+    /*!
+     * Returns the maximum number of services resolved at the same time
+     * on behalf of auto-resolving browsers.
+     *
+     * \sa setMaximumConcurrentResolves()
+     *
+     * \since 6.28
+     */
+    static int maximumConcurrentResolves();
+
+    /*!
+     * Returns a browser for \a type that is shared with everyone else
+     * asking for the same.
+     *
+     * Browsing the same type in several places of an application with
+     * separate ServiceBrowser objects costs a browse in the DNS-SD daemon
+     * for each of them. Browsers obtained from this function are shared by
+     * all requests with the same \a type, \a autoResolve, \a domain and
+     * \a subtype instead.
+     *
+     * Once the last reference is dropped, the browser is paused and kept
+     * for a while. Asking for it again resumes it, so that the services
+     * found before are available from services() right away and only the
+     * changes since are reported. How many released browsers are kept is
+     * set with setSharedCacheSize().
+     *
+     * Connect to the signals of the browser and call startBrowse() on it,
+     * which has no effect if someone else started it already. Signals like
+     * finished() emitted before that are not repeated, read the services
+     * found so far from services(). ServiceModel accepts a shared browser
+     * directly:
+     * \code
+     * auto model = new KDNSSD::ServiceModel(KDNSSD::ServiceBrowser::shared(QStringLiteral("_http._tcp"), true), this);
+     * \endcode
+     *
+     * Browsers are only shared within a thread, each thread asking for the
+     * same gets a browser of its own. A browser whose last reference is
+     * dropped in another thread is deleted instead of being kept.
+     *
+     * \warning A shared browser must not be stopped, paused or switched to
+     * record mode, that would affect everyone else using it.
+     *
+     * \sa setSharedCacheSize()
+     * \since 6.28
+     */
+    static QSharedPointer<ServiceBrowser>
+    shared(const QString &type, bool autoResolve = false, const QString &domain = QString(), const QString &subtype = QString());
+
+    /*!
+     * Sets how many shared browsers nobody uses anymore are kept for
+     * later, the least recently used ones are deleted first.
+     *
+     * Kept browsers are paused and do not browse, but they hold on to the
+     * services they found. The default is 8, 0 deletes shared browsers as
+     * soon as nobody uses them.
+     *
+     * \sa shared()
+     * \since 6.28
+     */
+    static void setSharedCacheSize(int size);
+
+    /*!
+     * Returns how many unused shared browsers are kept for later.
+     *
+     * \sa setSharedCacheSize()
+     * \since 6.28
+     */
+    static int sharedCacheSize();
+
 Q_SIGNALS:
     /*!
      * Emitted when new service is discovered.
@@ -247,6 +456,56 @@ Q_SIGNALS:
      */
     void serviceRemoved(KDNSSD::RemoteService::Ptr service);
 
+    /*!
+     * Emitted with all services discovered in one burst.
+     *
+     * Services reported in quick succession, such as when a browser is
+     * started on a busy network, are collected and emitted together once
+     * the burst is over. Each of them is also reported by serviceAdded()
+     * as soon as it is known. A service that disappears again before the
+     * batch is emitted is in neither this list nor in servicesRemoved().
+     *
+     * \a services the RemoteService objects describing the services
+     *
+     * \sa servicesRemoved() and serviceAdded()
+     * \since 6.28
+     */
+    void servicesAdded(const QList<KDNSSD::RemoteService::Ptr> &services);
+
+    /*!
+     * Emitted with all services that disappeared in one burst.
+     *
+     * This is the batched counterpart of serviceRemoved(). It is emitted
+     * before servicesAdded() when both have services to report.
+     *
+     * \a services the RemoteService objects describing the services
+     *
+     * \sa servicesAdded() and serviceRemoved()
+     * \since 6.28
+     */
+    void servicesRemoved(const QList<KDNSSD::RemoteService::Ptr> &services);
+
+    /*!
+     * Emitted in record mode when a new service is discovered.
+     *
+     * \a record identifies the service
+     *
+     * \sa setRecordMode() and recordRemoved()
+     * \since 6.28
+     */
+    void recordAdded(const KDNSSD::ServiceRecord &record);
+
+    /*!
+     * Emitted in record mode when a service is no longer published over
+     * DNS-SD.
+     *
+     * \a record identifies the service
+     *
+     * \sa setRecordMode() and recordAdded()
+     * \since 6.28
+     */
+    void recordRemoved(const KDNSSD::ServiceRecord &record);
+
     /*!
      * Emitted when the list of published services has settled.
      *
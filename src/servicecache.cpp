@@ -0,0 +1,104 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "servicecache_p.h"
+#include "kdnssd_debug.h"
+
+// lifetime of SRV and TXT records as recommended by RFC 6762
+#define CACHE_EXPIRY 120000
+
+namespace KDNSSD
+{
+Q_GLOBAL_STATIC(ServiceCache, s_cache)
+
+ServiceCache::ServiceCache()
+    : ServiceCache(CACHE_EXPIRY)
+{
+}
+
+ServiceCache::ServiceCache(qint64 expiry)
+    : m_expiry(expiry)
+{
+}
+
+ServiceCache *ServiceCache::self()
+{
+    return s_cache();
+}
+
+bool ServiceCache::lookup(ServiceBasePrivate *d)
+{
+    QMutexLocker locker(&m_mutex);
+    const auto it = m_entries.constFind(ServiceKey(d->m_serviceName, d->m_type, d->m_domain));
+    if (it == m_entries.constEnd()) {
+        return false;
+    }
+    if (it->age.hasExpired(m_expiry)) {
+        m_entries.erase(it);
+        return false;
+    }
+    d->m_hostName = it->hostName;
+    d->m_port = it->port;
+    d->m_textData = it->textData;
+    return true;
+}
+
+bool ServiceCache::lookupForResolve(ServiceBasePrivate *d)
+{
+    const bool hit = lookup(d);
+    QMutexLocker locker(&m_mutex);
+    if (hit) {
+        ++m_hits;
+    } else {
+        ++m_misses;
+    }
+    qCDebug(KDNSSD_LOG) << "Resolve cache" << (hit ? "hit" : "miss") << "for" << d->m_serviceName << d->m_type << "- hits:" << m_hits << "misses:" << m_misses;
+    return hit;
+}
+
+void ServiceCache::insert(const QString &name, const QString &type, const QString &domain, const ServiceBasePrivate *d)
+{
+    QMutexLocker locker(&m_mutex);
+    Entry &entry = m_entries[ServiceKey(name, type, domain)];
+    entry.hostName = d->m_hostName;
+    entry.port = d->m_port;
+    entry.textData = d->m_textData;
+    entry.age.start();
+
+    if (m_entries.size() > m_pruneThreshold) {
+        pruneExpired();
+        m_pruneThreshold = qMax<qsizetype>(256, m_entries.size() * 2);
+    }
+}
+
+void ServiceCache::remove(const QString &name, const QString &type, const QString &domain)
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.remove(ServiceKey(name, type, domain));
+}
+
+quint64 ServiceCache::hits() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hits;
+}
+
+quint64 ServiceCache::misses() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_misses;
+}
+
+void ServiceCache::pruneExpired()
+{
+    m_entries.removeIf([this](QHash<ServiceKey, Entry>::iterator it) {
+        return it->age.hasExpired(m_expiry);
+    });
+}
+
+}
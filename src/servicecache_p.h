@@ -0,0 +1,66 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef SERVICECACHE_P_H
+#define SERVICECACHE_P_H
+
+#include "servicebase_p.h"
+#include <QElapsedTimer>
+#include <QMutex>
+
+namespace KDNSSD
+{
+
+// Process wide cache of resolve results, so that the same service found by
+// several browsers, or resolved explicitly as well, only goes over the bus
+// once. Entries expire after the usual mDNS record lifetime and are dropped
+// as soon as a browser sees the service go away.
+class ServiceCache
+{
+public:
+    ServiceCache();
+    // entries expire after expiry ms instead of the record lifetime
+    explicit ServiceCache(qint64 expiry);
+
+    static ServiceCache *self();
+
+    // Fills host, port and text data of d from the cache, keyed by its name,
+    // type and domain. Returns false if there is no valid entry.
+    bool lookup(ServiceBasePrivate *d);
+    // Same as lookup() for a resolve that was asked for, which counts as a
+    // cache hit or as a miss that has to go to the daemon.
+    bool lookupForResolve(ServiceBasePrivate *d);
+
+    void insert(const QString &name, const QString &type, const QString &domain, const ServiceBasePrivate *d);
+    void remove(const QString &name, const QString &type, const QString &domain);
+
+    // resolves answered from the cache and those that were not
+    quint64 hits() const;
+    quint64 misses() const;
+
+private:
+    struct Entry {
+        QString hostName;
+        unsigned short port;
+        TxtRecord textData;
+        QElapsedTimer age;
+    };
+
+    void pruneExpired();
+
+    mutable QMutex m_mutex;
+    const qint64 m_expiry;
+    QHash<ServiceKey, Entry> m_entries;
+    qsizetype m_pruneThreshold = 256;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+};
+
+}
+
+#endif
@@ -8,21 +8,136 @@
 
 #include "servicemodel.h"
 #include "servicebrowser.h"
+#include <QHash>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
 
 namespace KDNSSD
 {
 struct ServiceModelPrivate {
+    ServiceModelPrivate(ServiceModel *parent)
+        : m_parent(parent)
+    {
+    }
+
+    void connectBrowser();
+    void addServices(const QList<RemoteService::Ptr> &services);
+    void removeServices(const QList<RemoteService::Ptr> &services);
+    void serviceResolved(RemoteService *service);
+
+    ServiceModel *const m_parent;
     ServiceBrowser *m_browser;
+    // keeps a shared browser alive, unset for a browser we own
+    QSharedPointer<ServiceBrowser> m_shared;
+    // our own copy of the rows, so that views are told exactly what changed
+    QList<RemoteService::Ptr> m_services;
+    // row of each service in m_services
+    QHash<RemoteService *, int> m_rows;
 };
 
+void ServiceModelPrivate::connectBrowser()
+{
+    // a burst of arrivals becomes a single row insertion
+    QObject::connect(m_browser, &ServiceBrowser::servicesAdded, m_parent, [this](const QList<RemoteService::Ptr> &services) {
+        addServices(services);
+    });
+    QObject::connect(m_browser, &ServiceBrowser::servicesRemoved, m_parent, [this](const QList<RemoteService::Ptr> &services) {
+        removeServices(services);
+    });
+}
+
+void ServiceModelPrivate::addServices(const QList<RemoteService::Ptr> &services)
+{
+    // A shared browser may still have services in its pending batch that
+    // we took from services() already.
+    QList<RemoteService::Ptr> added;
+    added.reserve(services.size());
+    const int first = m_services.size();
+    for (const RemoteService::Ptr &service : services) {
+        if (!m_rows.contains(service.data())) {
+            m_rows.insert(service.data(), first + added.size());
+            added.append(service);
+        }
+    }
+    if (added.isEmpty()) {
+        return;
+    }
+
+    m_parent->beginInsertRows(QModelIndex(), first, first + added.size() - 1);
+    m_services.append(added);
+    m_parent->endInsertRows();
+    for (const RemoteService::Ptr &service : std::as_const(added)) {
+        // host and port may change when the service is resolved again
+        QObject::connect(service.data(), &RemoteService::resolved, m_parent, [this, svr = service.data()]() {
+            serviceResolved(svr);
+        });
+    }
+}
+
+void ServiceModelPrivate::removeServices(const QList<RemoteService::Ptr> &services)
+{
+    QList<int> rows;
+    rows.reserve(services.size());
+    for (const RemoteService::Ptr &service : services) {
+        const auto it = m_rows.constFind(service.data());
+        if (it == m_rows.constEnd()) {
+            continue;
+        }
+        rows.append(it.value());
+        m_rows.erase(it);
+        QObject::disconnect(service.data(), &RemoteService::resolved, m_parent, nullptr);
+    }
+    if (rows.isEmpty()) {
+        return;
+    }
+
+    // Runs of adjacent rows go in one step each. Starting from the bottom
+    // keeps the rows of the runs still to come where they are.
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    for (qsizetype i = 0; i < rows.size();) {
+        const int last = rows.at(i);
+        int first = last;
+        while (++i < rows.size() && rows.at(i) == first - 1) {
+            --first;
+        }
+        m_parent->beginRemoveRows(QModelIndex(), first, last);
+        m_services.remove(first, last - first + 1);
+        m_parent->endRemoveRows();
+    }
+    // only the rows below the first removed one moved
+    for (int row = rows.last(); row < m_services.size(); ++row) {
+        m_rows[m_services.at(row).data()] = row;
+    }
+}
+
+void ServiceModelPrivate::serviceResolved(RemoteService *service)
+{
+    const int row = m_rows.value(service, -1);
+    if (row >= 0) {
+        Q_EMIT m_parent->dataChanged(m_parent->index(row, 0), m_parent->index(row, m_parent->columnCount() - 1));
+    }
+}
+
 ServiceModel::ServiceModel(ServiceBrowser *browser, QObject *parent)
     : QAbstractItemModel(parent)
-    , d(new ServiceModelPrivate)
+    , d(new ServiceModelPrivate(this))
 {
     d->m_browser = browser;
     browser->setParent(this);
-    connect(browser, SIGNAL(serviceAdded(KDNSSD::RemoteService::Ptr)), this, SIGNAL(layoutChanged()));
-    connect(browser, SIGNAL(serviceRemoved(KDNSSD::RemoteService::Ptr)), this, SIGNAL(layoutChanged()));
+    d->connectBrowser();
+    browser->startBrowse();
+}
+
+ServiceModel::ServiceModel(const QSharedPointer<ServiceBrowser> &browser, QObject *parent)
+    : QAbstractItemModel(parent)
+    , d(new ServiceModelPrivate(this))
+{
+    d->m_browser = browser.data();
+    d->m_shared = browser;
+    d->connectBrowser();
+    d->addServices(browser->services());
     browser->startBrowse();
 }
 
@@ -34,7 +149,7 @@ int ServiceModel::columnCount(const QModelIndex &) const
 }
 int ServiceModel::rowCount(const QModelIndex &parent) const
 {
-    return (parent.isValid()) ? 0 : d->m_browser->services().size();
+    return (parent.isValid()) ? 0 : d->m_services.size();
 }
 
 QModelIndex ServiceModel::parent(const QModelIndex &) const
@@ -69,21 +184,21 @@ QVariant ServiceModel::data(const QModelIndex &index, int role) const
     if (!hasIndex(index.row(), index.column(), index.parent())) {
         return QVariant();
     }
-    const QList<RemoteService::Ptr> srv = d->m_browser->services();
+    const RemoteService::Ptr &srv = d->m_services.at(index.row());
     switch ((uint)role) {
     case Qt::DisplayRole:
         switch (index.column()) {
         case ServiceName:
-            return srv[index.row()]->serviceName();
+            return srv->serviceName();
         case Host:
-            return srv[index.row()]->hostName();
+            return srv->hostName();
         case Port:
-            return srv[index.row()]->port();
+            return srv->port();
         }
         break;
     case ServicePtrRole:
         QVariant ret;
-        ret.setValue(srv[index.row()]);
+        ret.setValue(srv);
         return ret;
     }
     return QVariant();
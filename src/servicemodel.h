@@ -12,6 +12,7 @@
 #include "kdnssd_export.h"
 #include "remoteservice.h"
 #include <QAbstractItemModel>
+#include <QSharedPointer>
 #include <memory>
 
 namespace KDNSSD
@@ -99,6 +100,17 @@ public:
      */
     explicit ServiceModel(ServiceBrowser *browser, QObject *parent = nullptr);
 
+    /*!
+     * Creates a model for a \a browser obtained from ServiceBrowser::shared()
+     * and starts browsing if nobody did already.
+     *
+     * The services \a browser has found so far are in the model right away.
+     * The model keeps a reference to the browser as long as it exists.
+     *
+     * \since 6.28
+     */
+    explicit ServiceModel(const QSharedPointer<ServiceBrowser> &browser, QObject *parent = nullptr);
+
     ~ServiceModel() override;
 
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
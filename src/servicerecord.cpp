@@ -0,0 +1,64 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "servicerecord.h"
+
+namespace KDNSSD
+{
+class ServiceRecordPrivate : public QSharedData
+{
+public:
+    ServiceRecordPrivate(const QString &serviceName, const QString &type, const QString &domain)
+        : m_serviceName(serviceName)
+        , m_type(type)
+        , m_domain(domain)
+    {
+    }
+
+    QString m_serviceName;
+    QString m_type;
+    QString m_domain;
+};
+
+ServiceRecord::ServiceRecord()
+    : ServiceRecord(QString(), QString(), QString())
+{
+}
+
+ServiceRecord::ServiceRecord(const QString &serviceName, const QString &type, const QString &domain)
+    : d(new ServiceRecordPrivate(serviceName, type, domain))
+{
+}
+
+ServiceRecord::ServiceRecord(const ServiceRecord &other) = default;
+ServiceRecord::ServiceRecord(ServiceRecord &&other) noexcept = default;
+ServiceRecord &ServiceRecord::operator=(const ServiceRecord &other) = default;
+ServiceRecord &ServiceRecord::operator=(ServiceRecord &&other) noexcept = default;
+ServiceRecord::~ServiceRecord() = default;
+
+QString ServiceRecord::serviceName() const
+{
+    return d->m_serviceName;
+}
+
+QString ServiceRecord::type() const
+{
+    return d->m_type;
+}
+
+QString ServiceRecord::domain() const
+{
+    return d->m_domain;
+}
+
+bool ServiceRecord::operator==(const ServiceRecord &other) const
+{
+    return d->m_serviceName == other.d->m_serviceName && d->m_type == other.d->m_type && d->m_domain == other.d->m_domain;
+}
+
+}
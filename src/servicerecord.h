@@ -0,0 +1,98 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KDNSSDSERVICERECORD_H
+#define KDNSSDSERVICERECORD_H
+
+#include "kdnssd_export.h"
+#include <QMetaType>
+#include <QSharedDataPointer>
+#include <QString>
+
+namespace KDNSSD
+{
+/*!
+ * \class KDNSSD::ServiceRecord
+ * \inmodule KDNSSD
+ * \inheaderfile KDNSSD/ServiceRecord
+ *
+ * \brief Identifies a service found by a ServiceBrowser in record mode.
+ *
+ * A ServiceRecord is a plain value holding the name, type and domain of a
+ * service. Unlike RemoteService it is not a QObject and cannot be
+ * resolved. Use ServiceBrowser::service() with serviceName() to get a
+ * RemoteService for it when more than its identity is needed.
+ *
+ * \sa ServiceBrowser::setRecordMode()
+ * \since 6.28
+ */
+class ServiceRecordPrivate;
+
+class KDNSSD_EXPORT ServiceRecord
+{
+public:
+    /*!
+     * Creates an empty record.
+     */
+    ServiceRecord();
+
+    /*!
+     * Creates a record for the service called \a serviceName of type
+     * \a type in domain \a domain.
+     */
+    ServiceRecord(const QString &serviceName, const QString &type, const QString &domain);
+
+    ServiceRecord(const ServiceRecord &other);
+    ServiceRecord(ServiceRecord &&other) noexcept;
+    ServiceRecord &operator=(const ServiceRecord &other);
+    ServiceRecord &operator=(ServiceRecord &&other) noexcept;
+    ~ServiceRecord();
+
+    void swap(ServiceRecord &other) noexcept
+    {
+        d.swap(other.d);
+    }
+
+    /*!
+     * The name of the service.
+     */
+    QString serviceName() const;
+
+    /*!
+     * The type of the service, for example \c "_http._tcp".
+     */
+    QString type() const;
+
+    /*!
+     * The domain the service is published in.
+     */
+    QString domain() const;
+
+    /*!
+     * Returns \c true if \a other describes the same service.
+     */
+    bool operator==(const ServiceRecord &other) const;
+
+    /*!
+     * Returns \c true if \a other describes a different service.
+     */
+    bool operator!=(const ServiceRecord &other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    QSharedDataPointer<ServiceRecordPrivate> d;
+};
+
+}
+
+Q_DECLARE_TYPEINFO(KDNSSD::ServiceRecord, Q_RELOCATABLE_TYPE);
+Q_DECLARE_METATYPE(KDNSSD::ServiceRecord)
+
+#endif
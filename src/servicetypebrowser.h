@@ -68,9 +68,10 @@ public:
     /*!
      * Starts browsing for published services.
      *
-     * \note Only the first call to this function will have any effect.
+     * \note This has no effect while browsing is running or paused.
      *
-     * Browsing stops when the ServiceTypeBrowser object is destroyed.
+     * Browsing stops when the ServiceTypeBrowser object is destroyed or
+     * stopBrowse() is called.
      *
      * \warning The serviceTypeAdded() signal may be emitted before this
      *          function returns.
@@ -79,6 +80,49 @@ public:
      */
     void startBrowse();
 
+    /*!
+     * Stops browsing.
+     *
+     * Everything held in the DNS-SD daemon on behalf of this browser is freed
+     * and the service types found so far are forgotten, serviceTypeRemoved() is
+     * not emitted for them. Browsing can be started again with startBrowse().
+     *
+     * \sa pause()
+     * \since 6.28
+     */
+    void stopBrowse();
+
+    /*!
+     * Suspends browsing, e.g. while the view showing the results is hidden.
+     *
+     * Like stopBrowse() this frees everything held in the DNS-SD daemon, so a
+     * paused browser puts no load on it. The service types found so far are kept
+     * though and can still be read from serviceTypes().
+     *
+     * \sa resume() and isPaused()
+     * \since 6.28
+     */
+    void pause();
+
+    /*!
+     * Continues browsing after pause().
+     *
+     * The service types known from before are not reported again, only the
+     * changes are: serviceTypeAdded() for those that appeared in the meantime
+     * and serviceTypeRemoved() for those that are not found again.
+     *
+     * \since 6.28
+     */
+    void resume();
+
+    /*!
+     * Whether browsing is paused.
+     *
+     * \sa pause()
+     * \since 6.28
+     */
+    bool isPaused() const;
+
 Q_SIGNALS:
     /*!
      * Emitted when there are no more services of this type.
@@ -0,0 +1,41 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "stringpool_p.h"
+
+// TXT keys come from the network, don't let a misbehaving peer grow the pool
+// without bounds
+#define MAX_POOLED_STRINGS 4096
+#define MAX_POOLED_LENGTH 64
+
+namespace KDNSSD
+{
+Q_GLOBAL_STATIC(StringPool, s_pool)
+
+StringPool *StringPool::self()
+{
+    return s_pool();
+}
+
+QString StringPool::intern(const QString &s)
+{
+    if (s.size() > MAX_POOLED_LENGTH) {
+        return s;
+    }
+    QMutexLocker locker(&m_mutex);
+    const auto it = m_strings.constFind(s);
+    if (it != m_strings.constEnd()) {
+        return *it;
+    }
+    if (m_strings.size() < MAX_POOLED_STRINGS) {
+        m_strings.insert(s);
+    }
+    return s;
+}
+
+}
@@ -0,0 +1,37 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef STRINGPOOL_P_H
+#define STRINGPOOL_P_H
+
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+namespace KDNSSD
+{
+// Process wide table of strings that are received over and over again, like
+// service types, domains and TXT keys. Strings demarshalled from the bus or
+// converted from the daemon's C strings are all separate copies; running
+// them through intern() makes all services share a single one.
+class StringPool
+{
+public:
+    static StringPool *self();
+
+    // Returns the pooled copy of s, adding s to the pool if needed.
+    QString intern(const QString &s);
+
+private:
+    QMutex m_mutex;
+    QSet<QString> m_strings;
+};
+
+}
+
+#endif
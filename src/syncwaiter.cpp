@@ -0,0 +1,41 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "syncwaiter_p.h"
+#include <QTimer>
+
+namespace KDNSSD
+{
+ServiceBase::WaitResult SyncWaiter::wait(QDeadlineTimer deadline)
+{
+    if (!m_result && !deadline.hasExpired()) {
+        QTimer timer;
+        if (!deadline.isForever()) {
+            timer.setSingleShot(true);
+            timer.setTimerType(deadline.timerType());
+            QObject::connect(&timer, &QTimer::timeout, &m_loop, &QEventLoop::quit);
+            timer.start(deadline.remainingTimeAsDuration());
+        }
+        m_loop.exec(QEventLoop::ExcludeUserInputEvents);
+    }
+    if (!m_result) {
+        return ServiceBase::TimedOut;
+    }
+    return *m_result ? ServiceBase::Succeeded : ServiceBase::Failed;
+}
+
+void SyncWaiter::finish(bool successful)
+{
+    // monitoring services may report again, the first result counts
+    if (!m_result) {
+        m_result = successful;
+        m_loop.quit();
+    }
+}
+
+}
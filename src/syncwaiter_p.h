@@ -0,0 +1,51 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef SYNCWAITER_P_H
+#define SYNCWAITER_P_H
+
+#include "servicebase.h"
+#include <QDeadlineTimer>
+#include <QEventLoop>
+#include <QObject>
+
+#include <optional>
+
+namespace KDNSSD
+{
+// Backs the synchronous resolve() and publish() calls whose result arrives
+// as a signal. wait() blocks in a local event loop until the watched signal
+// reports a result, so the thread sleeps in the event dispatcher instead of
+// spinning. That loop runs every timer, socket notifier and queued call of
+// the calling thread, the application is re-entered while waiting. Where a
+// single reply carries the result, wait for that instead.
+class SyncWaiter
+{
+public:
+    template<typename Sender>
+    SyncWaiter(Sender *sender, void (Sender::*signal)(bool))
+    {
+        QObject::connect(sender, signal, &m_loop, [this](bool successful) {
+            finish(successful);
+        });
+    }
+
+    // Returns right away if the result arrived already, e.g. while the
+    // request was being started.
+    ServiceBase::WaitResult wait(QDeadlineTimer deadline);
+    // Ends the wait as failed, for requests that are stopped without a result.
+    void finish(bool successful);
+
+private:
+    QEventLoop m_loop;
+    std::optional<bool> m_result;
+};
+
+}
+
+#endif
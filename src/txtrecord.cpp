@@ -0,0 +1,156 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "txtrecord_p.h"
+#include "stringpool_p.h"
+
+// a TXT string is preceded by a single length byte
+#define MAX_TXT_STRING 255
+
+namespace KDNSSD
+{
+TxtRecord TxtRecord::fromWire(const QByteArray &wire)
+{
+    TxtRecord record;
+    record.setWire(wire);
+    return record;
+}
+
+TxtRecord TxtRecord::fromList(const QList<QByteArray> &strings)
+{
+    QByteArray wire;
+    qsizetype size = 0;
+    for (const QByteArray &string : strings) {
+        size += string.size() + 1;
+    }
+    wire.reserve(size);
+    for (const QByteArray &string : strings) {
+        if (string.isEmpty() || string.size() > MAX_TXT_STRING) {
+            continue;
+        }
+        wire.append(char(string.size()));
+        wire.append(string);
+    }
+    TxtRecord record;
+    record.setWire(wire);
+    return record;
+}
+
+TxtRecord TxtRecord::fromMap(const QMap<QString, QByteArray> &map)
+{
+    QByteArray wire;
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        QByteArray string = it.key().toUtf8();
+        if (string.isEmpty()) {
+            continue;
+        }
+        if (!it.value().isNull()) {
+            string += '=' + it.value();
+        }
+        if (string.size() > MAX_TXT_STRING) {
+            continue;
+        }
+        wire.append(char(string.size()));
+        wire.append(string);
+    }
+    TxtRecord record;
+    record.setWire(wire);
+    std::call_once(record.m_map->built, [&record, &map] {
+        record.m_map->map = map;
+    });
+    return record;
+}
+
+QList<QByteArray> TxtRecord::toList() const
+{
+    QList<QByteArray> strings;
+    strings.reserve(m_index.size());
+    for (const Entry &entry : std::as_const(m_index)) {
+        const int length = entry.keyLength + (entry.valueLength < 0 ? 0 : entry.valueLength + 1);
+        strings.append(m_wire.mid(entry.offset, length));
+    }
+    return strings;
+}
+
+qsizetype TxtRecord::size() const
+{
+    return m_index.size();
+}
+
+QByteArrayView TxtRecord::keyAt(qsizetype i) const
+{
+    const Entry &entry = m_index.at(i);
+    return QByteArrayView(m_wire.constData() + entry.offset, entry.keyLength);
+}
+
+QByteArrayView TxtRecord::valueAt(qsizetype i) const
+{
+    const Entry &entry = m_index.at(i);
+    if (entry.valueLength < 0) {
+        return QByteArrayView(m_wire.constData() + entry.offset + entry.keyLength, qsizetype(0));
+    }
+    return QByteArrayView(m_wire.constData() + entry.offset + entry.keyLength + 1, entry.valueLength);
+}
+
+QByteArrayView TxtRecord::value(QByteArrayView key) const
+{
+    for (qsizetype i = 0; i < m_index.size(); ++i) {
+        if (keyAt(i).compare(key, Qt::CaseInsensitive) == 0) {
+            return valueAt(i);
+        }
+    }
+    return QByteArrayView();
+}
+
+QMap<QString, QByteArray> TxtRecord::toMap() const
+{
+    if (!m_map) {
+        return QMap<QString, QByteArray>();
+    }
+    std::call_once(m_map->built, [this] {
+        for (qsizetype i = 0; i < m_index.size(); ++i) {
+            const QString key = StringPool::self()->intern(QString::fromUtf8(keyAt(i)));
+            // the first string with a key counts, as in value()
+            if (!m_map->map.contains(key)) {
+                m_map->map.insert(key, m_index.at(i).valueLength < 0 ? QByteArray() : valueAt(i).toByteArray());
+            }
+        }
+    });
+    return m_map->map;
+}
+
+void TxtRecord::setWire(const QByteArray &wire)
+{
+    m_wire = wire;
+    m_index.clear();
+    m_map = std::make_shared<MapCache>();
+
+    const char *data = m_wire.constData();
+    const qsizetype size = m_wire.size();
+    qsizetype pos = 0;
+    while (pos < size) {
+        const int length = uchar(data[pos]);
+        const qsizetype start = pos + 1;
+        if (start + length > size) {
+            // truncated, ignore the rest
+            break;
+        }
+        pos = start + length;
+
+        const QByteArrayView string(data + start, length);
+        const qsizetype separator = string.indexOf('=');
+        const qsizetype keyLength = separator < 0 ? length : separator;
+        // strings without a key are to be ignored
+        if (keyLength == 0) {
+            continue;
+        }
+        m_index.append(Entry{int(start), quint8(keyLength), qint16(separator < 0 ? -1 : length - separator - 1)});
+    }
+}
+
+}
@@ -0,0 +1,81 @@
+/*
+    This file is part of the KDE project
+
+    SPDX-FileCopyrightText: 2026 KDE Community
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef TXTRECORD_P_H
+#define TXTRECORD_P_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+#include <memory>
+#include <mutex>
+
+namespace KDNSSD
+{
+// TXT data of a service kept as it is sent over the wire: one buffer of
+// strings, each preceded by its length, plus where its entries start. The
+// QMap of the old textData() API is only built when somebody asks for it.
+// Like any Qt value type, a record may be read from several threads at once.
+class TxtRecord
+{
+public:
+    TxtRecord() = default;
+
+    // wire is the RDATA of a TXT record, as handed out by mDNSResponder
+    static TxtRecord fromWire(const QByteArray &wire);
+    // strings are the TXT strings without length prefix, as sent by Avahi
+    static TxtRecord fromList(const QList<QByteArray> &strings);
+    // entries that do not fit into a TXT string are left out of the wire
+    // data but still returned by toMap()
+    static TxtRecord fromMap(const QMap<QString, QByteArray> &map);
+
+    const QByteArray &wire() const
+    {
+        return m_wire;
+    }
+    QList<QByteArray> toList() const;
+
+    qsizetype size() const;
+    QByteArrayView keyAt(qsizetype i) const;
+    // an entry without '=' has an empty but non-null value
+    QByteArrayView valueAt(qsizetype i) const;
+    // keys are compared case insensitively and the first match wins, as
+    // RFC 6763 asks for. Returns a null view if there is no such key.
+    QByteArrayView value(QByteArrayView key) const;
+
+    QMap<QString, QByteArray> toMap() const;
+
+private:
+    struct Entry {
+        int offset;
+        quint8 keyLength;
+        // -1 if there is no '='
+        qint16 valueLength;
+    };
+
+    // The map is the same for all copies of a record, so they share it.
+    // std::call_once lets concurrent readers build it safely.
+    struct MapCache {
+        std::once_flag built;
+        QMap<QString, QByteArray> map;
+    };
+
+    // sets m_wire, indexes its entries and starts an empty map cache
+    void setWire(const QByteArray &wire);
+
+    QByteArray m_wire;
+    QList<Entry> m_index;
+    std::shared_ptr<MapCache> m_map;
+};
+
+}
+
+#endif